@@ -0,0 +1,103 @@
+//
+//  QueueContentionBenchmark.cpp
+//  Cinder-EventManager
+//
+//  Measures queueEvent throughput with 1-32 producer threads while the main
+//  thread keeps calling update(), for each QueueMode. QueueMode::MAIN_THREAD
+//  is made thread safe the way callers had to before the other modes
+//  existed, by wrapping queueEvent and update in one mutex.
+//
+
+#include "EventManager.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+	struct BenchmarkEvent : public EventData {
+		static const EventType TYPE = 0x2c6d90f1;
+		BenchmarkEvent() : EventData( TYPE ) {}
+		const char* getName() const override { return "BenchmarkEvent"; }
+	};
+
+	struct Listener {
+		void onEvent( const EventData& ) { ++mNumReceived; }
+		size_t mNumReceived = 0;
+	};
+
+	const size_t kTotalEvents = 1 << 21;
+
+	//! Returns millions of events per second from queueEvent to listener.
+	double run( EventManager::QueueMode mode, size_t numProducers )
+	{
+		auto manager = EventManager::create( "QueueContentionBenchmark", false, EventManager::Format().queueMode( mode ) );
+		Listener listener;
+		manager->addListener( BorrowedEventListenerDelegate( &listener, &Listener::onEvent ), BenchmarkEvent::TYPE );
+
+		const auto isLocked = mode == EventManager::QueueMode::MAIN_THREAD;
+		std::mutex mutex;
+		auto event = makeEvent<BenchmarkEvent>();
+		std::atomic<size_t> numReady( 0 ), numDone( 0 );
+		std::atomic<bool> start( false );
+		std::vector<std::thread> producers;
+		for( size_t i = 0; i < numProducers; ++i ) {
+			producers.emplace_back( [&] {
+				++numReady;
+				while( ! start )
+					std::this_thread::yield();
+				for( size_t j = 0; j < kTotalEvents / numProducers; ++j ) {
+					if( isLocked ) {
+						std::lock_guard<std::mutex> lock( mutex );
+						manager->queueEvent( event );
+					}
+					else {
+						manager->queueEvent( event );
+					}
+				}
+				++numDone;
+			} );
+		}
+		while( numReady < numProducers )
+			std::this_thread::yield();
+
+		const auto begin = std::chrono::steady_clock::now();
+		start = true;
+		const auto numExpected = kTotalEvents / numProducers * numProducers;
+		while( listener.mNumReceived < numExpected ) {
+			if( isLocked ) {
+				std::lock_guard<std::mutex> lock( mutex );
+				manager->update();
+			}
+			else {
+				manager->update();
+			}
+			if( numDone < numProducers )
+				std::this_thread::yield();
+		}
+		const auto seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - begin ).count();
+		for( auto &producer : producers )
+			producer.join();
+
+		return numExpected / seconds / 1e6;
+	}
+
+}
+
+int main()
+{
+	std::printf( "hardware threads: %u\n", std::thread::hardware_concurrency() );
+	std::printf( "producers   Mevents/s: MAIN_THREAD+mutex   CONCURRENT   PER_THREAD\n" );
+	for( size_t numProducers = 1; numProducers <= 32; numProducers *= 2 ) {
+		std::printf( "%9zu   %22.2f   %10.2f   %10.2f\n", numProducers,
+					run( EventManager::QueueMode::MAIN_THREAD, numProducers ),
+					run( EventManager::QueueMode::CONCURRENT, numProducers ),
+					run( EventManager::QueueMode::PER_THREAD, numProducers ) );
+	}
+
+	return 0;
+}
@@ -0,0 +1,94 @@
+//
+//  ThreadedTriggerBenchmark.cpp
+//  Cinder-EventManager
+//
+//  Measures how triggerThreadedEvent scales with the number of threads
+//  firing events at once, with and without listeners changing meanwhile.
+//
+
+#include "EventManager.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+namespace {
+
+	struct BenchmarkEvent : public EventData {
+		static const EventType TYPE = 0x7b3a1e52;
+		BenchmarkEvent() : EventData( TYPE ) {}
+		const char* getName() const override { return "BenchmarkEvent"; }
+	};
+
+	//! Written per thread, so the listener itself doesn't contend.
+	thread_local volatile float sSink = 0;
+
+	struct Listener {
+		void onEvent( const EventData &event ) { sSink = event.getTimeStamp(); }
+		void onOther( const EventData& ) {}
+	};
+
+	const size_t kEventsPerThread = 1 << 20;
+
+	//! Returns millions of events per second over all \a numThreads threads.
+	double run( EventManager &manager, size_t numThreads, bool churn )
+	{
+		auto event = makeEvent<BenchmarkEvent>();
+		std::atomic<size_t> numReady( 0 );
+		std::atomic<bool> start( false ), done( false );
+		std::vector<std::thread> threads;
+		for( size_t i = 0; i < numThreads; ++i ) {
+			threads.emplace_back( [&] {
+				++numReady;
+				while( ! start )
+					std::this_thread::yield();
+				for( size_t j = 0; j < kEventsPerThread; ++j )
+					manager.triggerThreadedEvent( event );
+			} );
+		}
+		while( numReady < numThreads )
+			std::this_thread::yield();
+
+		// Registers and removes a listener for another type in a loop, so every
+		// trigger has to notice a new snapshot now and then.
+		Listener other;
+		std::thread writer;
+		if( churn ) {
+			writer = std::thread( [&] {
+				while( ! done ) {
+					manager.addThreadedListener( BorrowedEventListenerDelegate( &other, &Listener::onOther ), BenchmarkEvent::TYPE + 1 );
+					manager.removeThreadedListener( BorrowedEventListenerDelegate( &other, &Listener::onOther ), BenchmarkEvent::TYPE + 1 );
+					std::this_thread::sleep_for( std::chrono::microseconds( 100 ) );
+				}
+			} );
+		}
+
+		const auto begin = std::chrono::steady_clock::now();
+		start = true;
+		for( auto &thread : threads )
+			thread.join();
+		const auto seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - begin ).count();
+		done = true;
+		if( writer.joinable() )
+			writer.join();
+
+		return numThreads * kEventsPerThread / seconds / 1e6;
+	}
+
+}
+
+int main()
+{
+	auto manager = EventManager::create( "ThreadedTriggerBenchmark", false );
+	Listener listener;
+	manager->addThreadedListener( BorrowedEventListenerDelegate( &listener, &Listener::onEvent ), BenchmarkEvent::TYPE );
+
+	std::printf( "hardware threads: %u\n", std::thread::hardware_concurrency() );
+	std::printf( "threads   Mevents/s   Mevents/s with listener churn\n" );
+	for( size_t numThreads = 1; numThreads <= 32; numThreads *= 2 )
+		std::printf( "%7zu   %9.2f   %9.2f\n", numThreads, run( *manager, numThreads, false ), run( *manager, numThreads, true ) );
+
+	return 0;
+}
@@ -9,7 +9,7 @@
 #pragma once
 
 // forward declaration
-using EventDataRef = std::shared_ptr<class EventData>;
+class MousePositionEvent;
 using CircleRef = std::shared_ptr<class Circle>;
 
 // This is just a simple class to show the event firings
@@ -46,7 +46,7 @@ public:
 	
 	//! This is the function we're most interested in. Check the
 	//! definition to see how it works.
-	void mouseEventDelegate( EventDataRef eventData );
+	void mouseEventDelegate( const MousePositionEvent &mouseEvent );
 	
 private:
 	//! activation function for the event.
@@ -11,8 +11,9 @@
 #include "cinder/Vector.h"
 
 #include "BaseEventData.h"
+#include "EventPool.h"
 
-using MousePositionEventRef = std::shared_ptr<class MousePositionEvent>;
+using MousePositionEventRef = EventPtr<class MousePositionEvent>;
 
 class MousePositionEvent : public EventData {
 public:
@@ -40,11 +41,13 @@ public:
 	virtual EventDataRef copy() { return create( mPosition ); }
 	
 	//! The RTTI of the EventManager to keep everything organized. Initialized
-	//! in the .cpp
+	//! in the .cpp and handed to EventData by our constructors, which is how
+	//! getTypeId() knows it.
 	static EventType TYPE;
-	//! Because this is virtual and we're overriding it, we can keep control
-	//! over the RTTI.
-	virtual EventType getEventType() const { return TYPE; }
+	//! Dense index handed out by the EventTypeRegistry for TYPE. Passing it
+	//! along lets the EventManager find our listeners with an array lookup
+	//! instead of hashing TYPE for every dispatch.
+	static EventTypeIndex TYPE_INDEX;
 	//! This is for debug purposes. We could've made it static but it needs to
 	//! be enforced that people write it.
 	virtual const char* getName() const { return "MouseEvent"; }
@@ -63,11 +66,14 @@ public:
 	virtual void deSerialize( const ci::Buffer &streamIn ) {}
 	
 	//! Getter for position.
-	ci::vec2 getPosition() { return mPosition; }
+	ci::vec2 getPosition() const { return mPosition; }
 	//! Setter for position.
 	void setPosition( ci::ivec2 position ) { mPosition = position; }
 	
 private:
+	//! The pool constructs us through EventPoolAccess, so it needs to be able
+	//! to reach the private constructors below.
+	friend struct EventPoolAccess;
 	//! Position is the only data member we need for our purposes.
 	explicit MousePositionEvent( ci::ivec2 position );
 	//! It's sometimes useful to have a default constructor, like in cases
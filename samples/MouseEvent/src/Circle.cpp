@@ -70,14 +70,13 @@ void Circle::initializeListener()
 	
 	if( eventManager ) {
 		
-		// create a fast delegate. Fast delegate is similar to a std::function in that it
-		// is a callable entity. It's an "impossibly fast delegate" functor. If you're
-		// interested beyond that check out...
+		// Behind the scenes this creates a fast delegate. Fast delegate is similar to a
+		// std::function in that it is a callable entity. It's an "impossibly fast delegate"
+		// functor. If you're interested beyond that check out...
 		// http://www.codeproject.com/Articles/11015/The-Impossibly-Fast-C-Delegates
-		auto thisListenerDelegate = fastdelegate::MakeDelegate( this, &Circle::mouseEventDelegate );
-		
-		// then add the delegate and what Type it's listening to to the eventManager
-		eventManager->addListener( thisListenerDelegate, MousePositionEvent::TYPE );
+		// Because mouseEventDelegate takes a MousePositionEvent, the eventManager knows
+		// both which Type it's listening to, MousePositionEvent::TYPE, and what to hand it.
+		eventManager->addListener( this, &Circle::mouseEventDelegate );
 		
 		// that's basically it. Internally, any time an event of MouseEvent::TYPE is either
 		// queued or triggered, this instance's Circle::mouseEventDelegate function will be
@@ -89,9 +88,8 @@ void Circle::uninitializeListener()
 {
 	auto eventManager = EventManager::get();
 	if( eventManager ) {
-		auto thisListenerDelegate = fastdelegate::MakeDelegate( this, &Circle::mouseEventDelegate );
 		// just as we call add we call remove.
-		eventManager->removeListener( thisListenerDelegate, MousePositionEvent::TYPE );
+		eventManager->removeListener( this, &Circle::mouseEventDelegate );
 	}
 }
 
@@ -109,22 +107,18 @@ void Circle::draw()
 	gl::drawSolidCircle( mPosition, mRadius );
 }
 
-void Circle::mouseEventDelegate( EventDataRef eventData )
+void Circle::mouseEventDelegate( const MousePositionEvent &mouseEvent )
 {
 	// First, we should exit if we're already activated.
 	if( mIsActivated ) return;
 	
 	// if we've made it to this function, then a MouseEvent must have been queued or
-	// triggered as above. So we can pretty safely dynamic_cast the shared_ptr.
-	auto mouseEvent = std::dynamic_pointer_cast<MousePositionEvent>( eventData );
-	
-	// "Pretty safely", because if you're working with others, they might have screwed
-	// something up because you would never screw things up. So, you might just want to
-	// check whether the pointer is correct...
-	// if( ! mouseEvent ) return;
+	// triggered as above. The eventManager already matched MousePositionEvent::TYPE,
+	// so it hands us the event as what it is; there's nothing to cast or check.
+	// (If someone queued something else under that TYPE, debug builds will assert.)
 	
 	// now you can get the event's data and work with it.
-	auto pos = mouseEvent->getPosition();
+	auto pos = mouseEvent.getPosition();
 	
 	if( pos.x < mPosition.x + mRadius && pos.x > mPosition.x - mRadius &&
 	   pos.y < mPosition.y + mRadius && pos.y > mPosition.y - mRadius ) {
@@ -133,7 +127,7 @@ void Circle::mouseEventDelegate( EventDataRef eventData )
 		activate();
 		// We don't want this event to continue so we're going to mark it as handled.
 		// This'll deactivate the event in the eventManager.
-		mouseEvent->setIsHandled( true );
+		mouseEvent.setIsHandled( true );
 	}
 }
 
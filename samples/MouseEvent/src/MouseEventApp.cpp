@@ -32,8 +32,10 @@ class MouseEventApp : public AppNative {
 void MouseEventApp::setup()
 {
 	// we first initialize the eventManager that we'll be using, Give it a name
-	// and we'll be making this global so I'm passing it true.
-	mEventManager = EventManager::create( "Global", true );
+	// and we'll be making this global so I'm passing it true. The Circles mark
+	// the mouse event as handled once one of them is picked, so we also ask the
+	// manager to stop handing the event to the remaining Circles at that point.
+	mEventManager = EventManager::create( "Global", true, EventManager::Format().stopOnHandled() );
 	// I know the number of Circles that i have and I want to use move semantics
 	// so I first reserve space for that number. If you were to remove this line
 	// you'd see that the Circles Copy Constructor is called, because of the
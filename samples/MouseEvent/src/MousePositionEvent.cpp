@@ -19,28 +19,34 @@ boost::hash<std::string> hasher;
 // Then I use the Event Class Name as the input to the hash, since it is
 // required for that name to be globally unique by C++.
 EventType MousePositionEvent::TYPE = hasher( "MousePositionEvent" );
+// Registering the type gives it a small index for the EventManager's dispatch
+// table. TYPE is defined above in this same file, so it is already initialized.
+EventTypeIndex MousePositionEvent::TYPE_INDEX = EventTypeRegistry::registerType( MousePositionEvent::TYPE );
 
 // This is our specialized creator that takes a position and
 // initializes our position data member. It also uses Cinder
 // to get the current timestamp
 MousePositionEvent::MousePositionEvent( ci::ivec2 position )
-: EventData( ci::app::App::get()->getElapsedSeconds() ), mPosition( position )
+: EventData( TYPE, ci::app::App::get()->getElapsedSeconds(), TYPE_INDEX ), mPosition( position )
 {
 }
 
 // This is our default that still uses Cinder to get the current
 // timestamp. This may or may not be useful.
 MousePositionEvent::MousePositionEvent()
-: EventData( ci::app::App::get()->getElapsedSeconds() )
+: EventData( TYPE, ci::app::App::get()->getElapsedSeconds(), TYPE_INDEX )
 {
 }
 
+// Mouse moves arrive constantly, so events come out of an EventPool. Once
+// the last reference to one drops its memory goes back to a free list for
+// the next create() instead of to the heap.
 MousePositionEventRef MousePositionEvent::create( ci::ivec2 position )
 {
-	return MousePositionEventRef( new MousePositionEvent( position ) );
+	return EventPool<MousePositionEvent>::create( position );
 }
 
 MousePositionEventRef MousePositionEvent::create()
 {
-	return MousePositionEventRef( new MousePositionEvent() );
+	return EventPool<MousePositionEvent>::create();
 }
\ No newline at end of file
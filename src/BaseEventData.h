@@ -13,36 +13,126 @@
 #pragma GCC visibility push(default)
 #pragma warning( pop )
 
+#include <atomic>
 #include <memory>
+#include <type_traits>
+#include "EventTypeRegistry.h"
+#include "EventRef.h"
 
 namespace cinder {
 	class Buffer;
 }
 
-using EventDataRef = std::shared_ptr<class EventData>;
+//! Handle type for events. Define CINDER_EVENTMANAGER_INTRUSIVE_REFS to have
+//! events count their own references and use EventRef instead of
+//! std::shared_ptr. Code that sticks to makeEvent(), EventPool, the
+//! EventManager factories and unqualified pointer casts builds either way.
+#if defined( CINDER_EVENTMANAGER_INTRUSIVE_REFS )
+template<typename T>
+using EventPtr = EventRef<T>;
+#else
+template<typename T>
+using EventPtr = std::shared_ptr<T>;
+#endif
+using EventDataRef = EventPtr<class EventData>;
 using EventType = uint64_t;
 	
 class EventData {
 public:
-	explicit EventData( float timestamp = 0.0f ) : mTimeStamp( timestamp ), mIsHandled( false ) {}
+	//! Subclasses pass their \a type, and the \a index EventTypeRegistry
+	//! assigned to it if they registered it. Both are stored so dispatch
+	//! reads them without a virtual call.
+	explicit EventData( EventType type, float timestamp = 0.0f, EventTypeIndex index = kInvalidEventTypeIndex )
+		: mTypeId( type ), mTypeIndex( index ), mTimeStamp( timestamp ), mIsHandled( false ) {}
+	//! Events used to supply their type through a virtual getTypeId(); this
+	//! catches constructors that still pass only a timestamp.
+	template<typename T, typename = typename std::enable_if<std::is_floating_point<T>::value>::type>
+	explicit EventData( T timestamp ) = delete;
 	virtual ~EventData() = default;
+#if defined( CINDER_EVENTMANAGER_INTRUSIVE_REFS )
+	//! Copies start out unreferenced.
+	EventData( const EventData &other )
+		: mTypeId( other.mTypeId ), mTypeIndex( other.mTypeIndex ), mTimeStamp( other.mTimeStamp ), mIsHandled( other.mIsHandled ) {}
+#endif
 
 	virtual const char* getName() const = 0;
-	virtual EventType getTypeId() const = 0;
+	EventType getTypeId() const { return mTypeId; }
+	//! Dense index of this event's type from EventTypeRegistry. Events
+	//! constructed with one are dispatched through a plain array lookup
+	//! instead of hashing getTypeId().
+	EventTypeIndex getTypeIndex() const { return mTypeIndex; }
 	float getTimeStamp() const { return mTimeStamp; }
 	
 	bool isHandled() const { return mIsHandled; }
-	void setIsHandled( bool handled = true ) { mIsHandled = handled; }
+	//! Dispatch state rather than event data, so listeners that only get a
+	//! const reference to the event can still stop its dispatch.
+	void setIsHandled( bool handled = true ) const { mIsHandled = handled; }
 	
 	virtual void serialize( cinder::Buffer &streamOut ) {}
 	virtual void deSerialize( const cinder::Buffer &streamIn ) {}
 	virtual EventDataRef copy() { return EventDataRef(); }
 	
+#if defined( CINDER_EVENTMANAGER_INTRUSIVE_REFS )
+	//! Called by EventRef. Events whose references stay on one thread may
+	//! switch to plain increments with setRefCountAtomic( false ) while at
+	//! most one reference exists.
+	void addRef() const
+	{
+		if( mIsRefCountAtomic )
+			mRefCount.fetch_add( 1, std::memory_order_relaxed );
+		else
+			mRefCount.store( mRefCount.load( std::memory_order_relaxed ) + 1, std::memory_order_relaxed );
+	}
+	void release() const
+	{
+		uint32_t remaining;
+		if( mIsRefCountAtomic ) {
+			remaining = mRefCount.fetch_sub( 1, std::memory_order_acq_rel ) - 1;
+		}
+		else {
+			remaining = mRefCount.load( std::memory_order_relaxed ) - 1;
+			mRefCount.store( remaining, std::memory_order_relaxed );
+		}
+		if( remaining == 0 )
+			mDestroy( const_cast<EventData*>( this ) );
+	}
+	uint32_t getRefCount() const { return mRefCount.load( std::memory_order_relaxed ); }
+	
+	void setRefCountAtomic( bool atomic ) { mIsRefCountAtomic = atomic; }
+	bool isRefCountAtomic() const { return mIsRefCountAtomic; }
+	
+	//! Replaces how the event is disposed of once its last reference is
+	//! released, for events that don't come from plain new.
+	using DestroyFn = void (*)( EventData *event );
+	void setDestroyFn( DestroyFn destroy ) { mDestroy = destroy; }
+#endif
+	
 private:
+	const EventType			mTypeId;
+	const EventTypeIndex	mTypeIndex;
 	const float mTimeStamp;
-	bool		mIsHandled;
+	mutable bool	mIsHandled;
+#if defined( CINDER_EVENTMANAGER_INTRUSIVE_REFS )
+	static void destroy( EventData *event ) { delete event; }
+	
+	mutable std::atomic<uint32_t>	mRefCount{ 0 };
+	bool							mIsRefCountAtomic = true;
+	DestroyFn						mDestroy = &EventData::destroy;
+#endif
 };
 
+//! Creates an event the way the configured EventDataRef expects, like
+//! std::make_shared does for std::shared_ptr.
+template<typename T, typename... Args>
+EventPtr<T> makeEvent( Args&&... args )
+{
+#if defined( CINDER_EVENTMANAGER_INTRUSIVE_REFS )
+	return EventPtr<T>( new T( std::forward<Args>( args )... ) );
+#else
+	return std::make_shared<T>( std::forward<Args>( args )... );
+#endif
+}
+
 #pragma warning( push )
 #pragma warning( disable : 4068 )
 #pragma GCC visibility pop
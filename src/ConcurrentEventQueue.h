@@ -0,0 +1,100 @@
+//
+//  ConcurrentEventQueue.h
+//  Cinder-EventManager
+//
+//  Lock-free multi-producer, single-consumer queue of events.
+//
+
+#pragma once
+#pragma warning( push )
+#pragma warning( disable : 4068 )
+/* The classes below are exported */
+#pragma GCC visibility push(default)
+#pragma warning( pop )
+
+#include <atomic>
+#include "EventPool.h"
+
+//! Unbounded intrusive MPSC queue (after Dmitry Vyukov's design). Any thread
+//! may push; pushing is a single atomic exchange plus a store, with no locks
+//! and no retry loop. Only the owning thread may pop. A pop can transiently
+//! report empty while a producer is between its exchange and its store; that
+//! event is simply picked up by the next pop. Nodes are recycled through
+//! EventPoolAllocator, so steady-state pushes don't touch the global heap.
+class ConcurrentEventQueue {
+public:
+	ConcurrentEventQueue() : mHead( &mStub ), mTail( &mStub ) { mStub.mNext.store( nullptr, std::memory_order_relaxed ); }
+	ConcurrentEventQueue( const ConcurrentEventQueue& ) = delete;
+	ConcurrentEventQueue& operator=( const ConcurrentEventQueue& ) = delete;
+	~ConcurrentEventQueue()
+	{
+		EventDataRef event;
+		while( pop( event ) )
+			;
+	}
+
+	//! Thread safe.
+	void push( EventDataRef event )
+	{
+		NodeAllocator allocator;
+		auto node = allocator.allocate( 1 );
+		::new( static_cast<void*>( node ) ) Node( std::move( event ) );
+		enqueue( node );
+	}
+
+	//! Owner thread only. Returns false if no completed push is available.
+	bool pop( EventDataRef &event )
+	{
+		auto tail = mTail;
+		auto next = tail->mNext.load( std::memory_order_acquire );
+		if( tail == &mStub ) {
+			if( ! next )
+				return false;
+			mTail = next;
+			tail = next;
+			next = next->mNext.load( std::memory_order_acquire );
+		}
+
+		if( ! next ) {
+			// tail is the last node we can see. Unless a producer is mid-push,
+			// park the stub behind it so tail can be handed out.
+			if( tail != mHead.load( std::memory_order_acquire ) )
+				return false;
+			enqueue( &mStub );
+			next = tail->mNext.load( std::memory_order_acquire );
+			if( ! next )
+				return false;
+		}
+
+		mTail = next;
+		event = std::move( tail->mEvent );
+		tail->~Node();
+		NodeAllocator().deallocate( tail, 1 );
+		return true;
+	}
+
+private:
+	struct Node {
+		Node() {}
+		explicit Node( EventDataRef event ) : mNext( nullptr ), mEvent( std::move( event ) ) {}
+		std::atomic<Node*>	mNext;
+		EventDataRef		mEvent;
+	};
+	using NodeAllocator = EventPoolAllocator<Node>;
+
+	void enqueue( Node *node )
+	{
+		node->mNext.store( nullptr, std::memory_order_relaxed );
+		auto prev = mHead.exchange( node, std::memory_order_acq_rel );
+		prev->mNext.store( node, std::memory_order_release );
+	}
+
+	std::atomic<Node*>	mHead;
+	Node				*mTail;
+	Node				mStub;
+};
+
+#pragma warning( push )
+#pragma warning( disable : 4068 )
+#pragma GCC visibility pop
+#pragma warning( pop )
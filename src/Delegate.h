@@ -0,0 +1,209 @@
+//
+//  Delegate.h
+//  Cinder-EventManager
+//
+//  Callable wrapper with inline storage and value equality.
+//
+
+#pragma once
+#pragma warning( push )
+#pragma warning( disable : 4068 )
+/* The classes below are exported */
+#pragma GCC visibility push(default)
+#pragma warning( pop )
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <type_traits>
+#include <utility>
+
+template<typename Signature>
+class Delegate;
+
+namespace delegate_detail {
+	//! Member function pointers to a class the compiler knows nothing about
+	//! are the largest kind on every ABI.
+	class UnknownClass;
+	using LargestMethod = void (UnknownClass::*)();
+}
+
+//! Calls a free function, a member function on an object or a small lambda
+//! through one function pointer, without FastDelegate's member function
+//! pointer casts. The target is copied into kInlineSize bytes inside the
+//! delegate and must be trivially copyable, so a Delegate never allocates
+//! and is itself trivially copyable.
+//!
+//! Delegates compare equal when they call the same kind of target with the
+//! same bytes: the same object and member function, the same function, or
+//! copies of the same lambda. That is what removing a listener by the
+//! delegate it was added with relies on. Separately created lambdas with
+//! equal captures compare equal too, unless their captures leave padding
+//! between them, whose bytes are unspecified.
+//!
+//!		Delegate<void( const EventData& )> d = makeDelegate( this, &Circle::onEvent );
+//!		Delegate<void( const EventData& )> l = [this]( const EventData &event ) { ... };
+template<typename R, typename... Args>
+class Delegate<R( Args... )> {
+public:
+	//! Room for an object pointer plus any member function pointer, which
+	//! also fits a lambda capturing three pointers.
+	static const size_t kInlineSize = sizeof( void* ) + sizeof( delegate_detail::LargestMethod );
+
+	Delegate() : mInvoke( nullptr ) { std::memset( &mStorage, 0, sizeof( mStorage ) ); }
+	Delegate( std::nullptr_t ) : Delegate() {}
+
+	Delegate( R (*function)( Args... ) ) : Delegate()
+	{
+		if( function )
+			store( &invokeFunction, function );
+	}
+
+	//! Binds \a method to \a object, which may be of a derived class.
+	template<typename Y, typename C>
+	Delegate( Y *object, R (C::*method)( Args... ) ) : Delegate()
+	{
+		store( &invokeMethod<C, R (C::*)( Args... )>, BoundMethod<C, R (C::*)( Args... )>{ static_cast<C*>( object ), method } );
+	}
+	template<typename Y, typename C>
+	Delegate( const Y *object, R (C::*method)( Args... ) const ) : Delegate()
+	{
+		store( &invokeMethod<const C, R (C::*)( Args... ) const>, BoundMethod<const C, R (C::*)( Args... ) const>{ static_cast<const C*>( object ), method } );
+	}
+
+	//! Binds the member function \a Method, given at compile time, to \a
+	//! object. The call then goes through a single function pointer with the
+	//! method's body inlined behind it, instead of also through a member
+	//! function pointer, and only the object pointer is stored.
+	//!
+	//!		auto d = Delegate<void( const EventData& )>::bind<Circle, &Circle::onEvent>( this );
+	template<typename C, R (C::*Method)( Args... )>
+	static Delegate bind( C *object )
+	{
+		Delegate delegate;
+		delegate.store( &invokeBound<C, Method>, object );
+		return delegate;
+	}
+	template<typename C, R (C::*Method)( Args... ) const>
+	static Delegate bind( const C *object )
+	{
+		Delegate delegate;
+		delegate.store( &invokeBoundConst<C, Method>, object );
+		return delegate;
+	}
+
+	//! Wraps a lambda or other function object, which must be trivially
+	//! copyable, fit into kInlineSize and be callable when const.
+	template<typename F, typename = typename std::enable_if<! std::is_same<typename std::decay<F>::type, Delegate>::value
+															&& ! std::is_pointer<typename std::decay<F>::type>::value>::type>
+	Delegate( F &&callable ) : Delegate()
+	{
+		using Callable = typename std::decay<F>::type;
+		store( &invokeCallable<Callable>, Callable( std::forward<F>( callable ) ) );
+	}
+
+	R operator()( Args... args ) const { return mInvoke( &mStorage, std::forward<Args>( args )... ); }
+
+	bool empty() const { return mInvoke == nullptr; }
+	explicit operator bool() const { return ! empty(); }
+	void clear() { *this = Delegate(); }
+
+	bool operator==( const Delegate &other ) const
+	{
+		return mInvoke == other.mInvoke && std::memcmp( &mStorage, &other.mStorage, sizeof( mStorage ) ) == 0;
+	}
+	bool operator!=( const Delegate &other ) const { return ! ( *this == other ); }
+
+	size_t hash() const
+	{
+		auto result = std::hash<Invoker>()( mInvoke );
+		uintptr_t words[sizeof( mStorage ) / sizeof( uintptr_t )];
+		std::memcpy( words, &mStorage, sizeof( words ) );
+		for( auto word : words )
+			result = result * 31 + std::hash<uintptr_t>()( word );
+		return result;
+	}
+
+private:
+	using Storage = typename std::aligned_storage<kInlineSize, alignof( void* )>::type;
+	using Invoker = R (*)( const void *storage, Args... args );
+
+	template<typename C, typename Method>
+	struct BoundMethod {
+		C		*mObject;
+		Method	mMethod;
+	};
+
+	//! Copies \a target's bytes into the zeroed storage, so unused bytes
+	//! compare and hash the same in every delegate.
+	template<typename T>
+	void store( Invoker invoke, const T &target )
+	{
+		static_assert( std::is_trivially_copyable<T>::value, "Delegate targets must be trivially copyable" );
+		static_assert( sizeof( T ) <= kInlineSize, "Delegate target exceeds Delegate::kInlineSize" );
+		static_assert( alignof( T ) <= alignof( Storage ), "Delegate target is over-aligned" );
+		static_assert( std::is_trivially_copyable<Delegate>::value, "Delegate must stay trivially copyable" );
+		std::memcpy( &mStorage, &target, sizeof( T ) );
+		mInvoke = invoke;
+	}
+
+	static R invokeFunction( const void *storage, Args... args )
+	{
+		R (*function)( Args... );
+		std::memcpy( &function, storage, sizeof( function ) );
+		return function( std::forward<Args>( args )... );
+	}
+	template<typename C, typename Method>
+	static R invokeMethod( const void *storage, Args... args )
+	{
+		const auto &bound = *static_cast<const BoundMethod<C, Method>*>( storage );
+		return ( bound.mObject->*bound.mMethod )( std::forward<Args>( args )... );
+	}
+	template<typename C, R (C::*Method)( Args... )>
+	static R invokeBound( const void *storage, Args... args )
+	{
+		C *object;
+		std::memcpy( &object, storage, sizeof( object ) );
+		return ( object->*Method )( std::forward<Args>( args )... );
+	}
+	template<typename C, R (C::*Method)( Args... ) const>
+	static R invokeBoundConst( const void *storage, Args... args )
+	{
+		const C *object;
+		std::memcpy( &object, storage, sizeof( object ) );
+		return ( object->*Method )( std::forward<Args>( args )... );
+	}
+	template<typename Callable>
+	static R invokeCallable( const void *storage, Args... args )
+	{
+		return ( *static_cast<const Callable*>( storage ) )( std::forward<Args>( args )... );
+	}
+
+	Invoker		mInvoke;
+	Storage		mStorage;
+};
+
+//! Binds \a method to \a object, deducing the signature.
+template<typename C, typename R, typename... Args>
+Delegate<R( Args... )> makeDelegate( C *object, R (C::*method)( Args... ) )
+{
+	return Delegate<R( Args... )>( object, method );
+}
+template<typename C, typename R, typename... Args>
+Delegate<R( Args... )> makeDelegate( const C *object, R (C::*method)( Args... ) const )
+{
+	return Delegate<R( Args... )>( object, method );
+}
+
+namespace std {
+	template<typename Signature>
+	struct hash<Delegate<Signature>> {
+		size_t operator()( const Delegate<Signature> &delegate ) const { return delegate.hash(); }
+	};
+}
+
+#pragma warning( push )
+#pragma warning( disable : 4068 )
+#pragma GCC visibility pop
+#pragma warning( pop )
@@ -0,0 +1,165 @@
+//
+//  EventArena.h
+//  Cinder-EventManager
+//
+//  Bump allocation for events that live for about one update.
+//
+
+#pragma once
+#pragma warning( push )
+#pragma warning( disable : 4068 )
+/* The classes below are exported */
+#pragma GCC visibility push(default)
+#pragma warning( pop )
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+#include "EventPool.h"
+
+//! Hands out memory by bumping an offset through a list of fixed-size chunks
+//! and only ever frees it all at once. Freeing an allocation just counts it;
+//! reset() rewinds to the first chunk, and refuses to while anything is still
+//! live, so an event someone held on to is never overwritten. Chunks are kept
+//! across resets. Allocation is single threaded, deallocation may happen on
+//! any thread.
+class EventArena {
+public:
+	explicit EventArena( size_t chunkSize = 64 * 1024 ) : mChunkSize( chunkSize ), mChunk( 0 ), mOffset( 0 ), mNumAllocated( 0 ), mNumFreed( 0 ) {}
+	EventArena( const EventArena& ) = delete;
+	EventArena& operator=( const EventArena& ) = delete;
+
+	void* allocate( size_t size, size_t alignment )
+	{
+		++mNumAllocated;
+		if( size + alignment > mChunkSize ) {
+			// Too large for any chunk; kept on the side until the next reset.
+			mOversized.emplace_back( new char[size + alignment] );
+			return align( mOversized.back().get(), alignment );
+		}
+
+		while( true ) {
+			if( mChunk == mChunks.size() )
+				mChunks.emplace_back( new char[mChunkSize] );
+
+			const auto chunk = mChunks[mChunk].get();
+			const auto p = align( chunk + mOffset, alignment );
+			if( p + size <= chunk + mChunkSize ) {
+				mOffset = static_cast<size_t>( p + size - chunk );
+				return p;
+			}
+			++mChunk;
+			mOffset = 0;
+		}
+	}
+
+	void deallocate( void * )
+	{
+		mNumFreed.fetch_add( 1, std::memory_order_release );
+	}
+
+	//! Makes all memory available again if nothing allocated from the arena
+	//! is still alive. Returns whether it did.
+	bool reset()
+	{
+		if( mNumFreed.load( std::memory_order_acquire ) != mNumAllocated )
+			return false;
+		// Nothing is live, so nothing can be freed concurrently.
+		mNumFreed.store( 0, std::memory_order_relaxed );
+		mNumAllocated = 0;
+		mChunk = 0;
+		mOffset = 0;
+		mOversized.clear();
+		return true;
+	}
+
+	//! Owner thread only.
+	size_t getNumLive() const { return mNumAllocated - mNumFreed.load( std::memory_order_acquire ); }
+	size_t getNumChunks() const { return mChunks.size(); }
+
+private:
+	static char* align( char *p, size_t alignment )
+	{
+		return reinterpret_cast<char*>( ( reinterpret_cast<uintptr_t>( p ) + alignment - 1 ) & ~uintptr_t( alignment - 1 ) );
+	}
+
+	const size_t						mChunkSize;
+	std::vector<std::unique_ptr<char[]>>	mChunks;
+	std::vector<std::unique_ptr<char[]>>	mOversized;
+	size_t								mChunk;
+	size_t								mOffset;
+	//! Only the owner thread allocates, so only frees need to be atomic.
+	size_t								mNumAllocated;
+	std::atomic<size_t>					mNumFreed;
+};
+
+//! Allocator over an EventArena, for std::allocate_shared. Constructs through
+//! EventPoolAccess like EventPoolAllocator does.
+template<typename T>
+class EventArenaAllocator {
+public:
+	using value_type = T;
+
+	explicit EventArenaAllocator( EventArena *arena ) : mArena( arena ) {}
+	template<typename U>
+	EventArenaAllocator( const EventArenaAllocator<U> &other ) : mArena( other.mArena ) {}
+
+	T* allocate( size_t n ) { return static_cast<T*>( mArena->allocate( n * sizeof( T ), alignof( T ) ) ); }
+	void deallocate( T *p, size_t ) { mArena->deallocate( p ); }
+
+	template<typename U, typename... Args>
+	void construct( U *p, Args&&... args ) { EventPoolAccess::construct( p, std::forward<Args>( args )... ); }
+	template<typename U>
+	void destroy( U *p ) { p->~U(); }
+
+	template<typename U>
+	bool operator==( const EventArenaAllocator<U> &other ) const { return mArena == other.mArena; }
+	template<typename U>
+	bool operator!=( const EventArenaAllocator<U> &other ) const { return mArena != other.mArena; }
+
+private:
+	template<typename U>
+	friend class EventArenaAllocator;
+
+	EventArena	*mArena;
+};
+
+//! Creates an event of type T in \a arena, whichever EventDataRef is. The
+//! event must be released before the arena is destroyed.
+template<typename T, typename... Args>
+EventPtr<T> createArenaEvent( EventArena *arena, Args&&... args )
+{
+#if defined( CINDER_EVENTMANAGER_INTRUSIVE_REFS )
+	// The event can't reach the arena on its own when its last reference
+	// goes, so it is placed right behind a pointer back to it.
+	struct Block {
+		EventArena	*mArena;
+		typename std::aligned_storage<sizeof( T ), alignof( T )>::type mStorage;
+		
+		static void destroy( EventData *event )
+		{
+			auto p = static_cast<T*>( event );
+			auto block = reinterpret_cast<Block*>( reinterpret_cast<char*>( p ) - offsetof( Block, mStorage ) );
+			p->~T();
+			block->mArena->deallocate( block );
+		}
+	};
+	
+	auto block = static_cast<Block*>( arena->allocate( sizeof( Block ), alignof( Block ) ) );
+	block->mArena = arena;
+	auto p = reinterpret_cast<T*>( &block->mStorage );
+	EventPoolAccess::construct( p, std::forward<Args>( args )... );
+	p->setDestroyFn( &Block::destroy );
+	return EventPtr<T>( p );
+#else
+	return std::allocate_shared<T>( EventArenaAllocator<T>( arena ), std::forward<Args>( args )... );
+#endif
+}
+
+#pragma warning( push )
+#pragma warning( disable : 4068 )
+#pragma GCC visibility pop
+#pragma warning( pop )
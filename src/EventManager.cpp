@@ -39,82 +39,153 @@
 #include "EventManager.h"
 #include <iostream>
 #include <cassert>
+#include <algorithm>
+#include <iterator>
+#include <functional>
+#include <chrono>
 #include "cinder/Log.h"
 
 //#define LOG_EVENT( stream )	CI_LOG_I( stream )
 #define LOG_EVENT( stream )	((void)0)
 
 using namespace std;
+
+static std::atomic<uint64_t> sNextId( 0 );
+//! Zero is left to invalid handles.
+static std::atomic<uint32_t> sNextListenerTableId( 1 );
+const size_t EventManager::kMaxClockCheckInterval;
 	
-EventManager::EventManager( std::string name, bool setAsGlobal ) : 
+EventManager::EventManager( std::string name, bool setAsGlobal, const Format &format ) : 
 	EventManagerBase( std::move( name ), setAsGlobal ), 
-	mActiveQueue( 0 ), 
+	mThreadedListenerSnapshot( std::make_shared<ThreadedListenerSnapshot>() ),
+	mThreadedListenerVersion( 0 ),
+	mNumAbortedEvents( 0 ),
+	mActiveArena( 0 ),
+	mQueueMode( format.getQueueMode() ),
+	mMergeOrder( format.getMergeOrder() ),
+	mStopOnHandled( format.getStopOnHandled() ),
+	mSingleThreaded( format.isSingleThreaded() ),
+	mId( sNextId++ ),
 	mFiringEvent( false )
 {
 	LOG_EVENT( "Creating event manager" );
+	assert( ! mSingleThreaded || mQueueMode == QueueMode::MAIN_THREAD );
+	mArenas[0].reset( new EventArena );
+	mArenas[1].reset( new EventArena );
 }
 	
 EventManager::~EventManager()
 {
 	LOG_EVENT( "Cleaning up event manager" );
 	mEventListeners.clear();
-	mQueues[0].clear();
-	mQueues[1].clear();
+	mQueue.clear();
+	{
+		// Producer threads still holding a queue drop it on their next
+		// queueEvent to another manager, or when they exit.
+		std::lock_guard<std::mutex> lock( mProducerQueuesMutex );
+		for( auto &producerQueue : mProducerQueues ) {
+			std::lock_guard<std::mutex> producerLock( producerQueue->mMutex );
+			producerQueue->mIsClosed = true;
+			producerQueue->mEvents.clear();
+		}
+		mProducerQueues.clear();
+	}
+	for( auto &arena : mArenas ) {
+		if( arena->getNumLive() > 0 ) {
+			LOG_EVENT( "WARNING: Frame events outlive their event manager; leaking their arena" );
+			arena.release();
+		}
+	}
 	LOG_EVENT( "Removing all threaded events");
 	std::lock_guard<std::mutex> lock( mThreadedEventListenerMutex );
 	mThreadedEventListeners.clear();
+	mThreadedListenerSnapshot.reset();
 	LOG_EVENT( "Removed ALL EVENT LISTENERS" );
 }
 	
-bool EventManager::addListener( EventListenerDelegate eventDelegate, EventType type )
+ListenerHandle EventManager::addListener( EventListenerDelegate eventDelegate, EventType type, int32_t priority )
+{
+	return insertListener( Listener( std::move( eventDelegate ) ), type, priority );
+}
+	
+ListenerHandle EventManager::addListener( BorrowedEventListenerDelegate eventDelegate, EventType type, int32_t priority )
+{
+	return insertListener( Listener( std::move( eventDelegate ) ), type, priority );
+}
+	
+ListenerHandle EventManager::addListener( EventDelegate eventDelegate, EventType type, int32_t priority )
+{
+	return insertListener( Listener( eventDelegate ), type, priority );
+}
+	
+ListenerHandle EventManager::insertListener( Listener listener, EventType type, int32_t priority )
 {
 	LOG_EVENT( "ADDING delegate function for event type: " + to_string( type ) );
 
-	if( mFiringEvent ) {
-		mAddAfter.emplace_back( type, std::move( eventDelegate ) );
-	}
-	else {
-		auto &eventDelegateList = mEventListeners[type];
-		auto listenIt = eventDelegateList.begin();
-		const auto end = eventDelegateList.end();
-		while( listenIt != end ) {
-			if( eventDelegate == (*listenIt) ) {
-				LOG_EVENT( "WARNING: Attempting to double-register a delegate" );
-				return false;
-			}
-			++listenIt;
-		}
-		eventDelegateList.emplace_back( std::move( eventDelegate ) );
+	// While firing, the new listener is appended so running dispatches keep
+	// their positions; they stop short of it.
+	const auto handle = mEventListeners.insert( type, std::move( listener ), priority, ! mFiringEvent );
+	if( ! handle ) {
+		LOG_EVENT( "WARNING: Attempting to double-register a delegate" );
+		return ListenerHandle();
 	}
 
 	LOG_EVENT( "ADDED delegate for event type: " + to_string( type ) );
 
-	return true;
+	return handle;
 }
 	
 bool EventManager::removeListener( EventListenerDelegate eventDelegate, EventType type )
 {
 	LOG_EVENT( "REMOVING delegate function from event type: " + to_string( type ) );
-	auto success = false;
 	
-	if( mFiringEvent ) {
-		mRemoveAfter.emplace_back( type, std::move( eventDelegate ) );
-	}
-	else {
-		auto found = mEventListeners.find( type );
-		if( found != mEventListeners.end() ) {
-			auto &listeners = found->second;
-			for( auto listIt = listeners.begin(); listIt != listeners.end(); ++listIt ) {
-				if( eventDelegate == (*listIt) ) {
-					listeners.erase( listIt );
-					LOG_EVENT( "REMOVED delegate function from event type: " );
-					success = true;
-					break;
-				}
-			}
-		}
+	return removeListener( mEventListeners.find( type, DelegateKey( eventDelegate ) ) );
+}
+	
+bool EventManager::removeListener( BorrowedEventListenerDelegate eventDelegate, EventType type )
+{
+	LOG_EVENT( "REMOVING delegate function from event type: " + to_string( type ) );
+	
+	return removeListener( mEventListeners.find( type, DelegateKey( eventDelegate ) ) );
+}
+	
+bool EventManager::removeListener( EventDelegate eventDelegate, EventType type )
+{
+	LOG_EVENT( "REMOVING delegate function from event type: " + to_string( type ) );
+	
+	return removeListener( mEventListeners.find( type, DelegateKey( eventDelegate ) ) );
+}
+	
+ListenerHandle EventManager::addBatchListener( EventBatchListenerDelegate eventDelegate, EventType type, int32_t priority )
+{
+	LOG_EVENT( "ADDING batch delegate function for event type: " + to_string( type ) );
+	
+	const auto handle = mEventListeners.insert( type, std::move( eventDelegate ), priority, ! mFiringEvent );
+	if( ! handle ) {
+		LOG_EVENT( "WARNING: Attempting to double-register a delegate" );
+		return ListenerHandle();
 	}
-
+	
+	LOG_EVENT( "ADDED batch delegate for event type: " + to_string( type ) );
+	
+	return handle;
+}
+	
+bool EventManager::removeBatchListener( EventBatchListenerDelegate eventDelegate, EventType type )
+{
+	LOG_EVENT( "REMOVING batch delegate function from event type: " + to_string( type ) );
+	
+	return removeListener( mEventListeners.find( type, DelegateKey( eventDelegate ) ) );
+}
+	
+bool EventManager::removeListener( ListenerHandle handle )
+{
+	// Removal during dispatch only leaves a tombstone, compaction waits for
+	// consumeAfterListeners.
+	const auto success = mEventListeners.remove( handle, ! mFiringEvent );
+	if( success )
+		LOG_EVENT( "REMOVED delegate function" );
+	
 	return success;
 }
 	
@@ -125,13 +196,27 @@ bool EventManager::triggerEvent( EventDataRef event )
 	const auto originalFiringEvent = mFiringEvent;
 	mFiringEvent = true;
 
-	const auto found = mEventListeners.find( event->getTypeId() );
-	if( found != mEventListeners.end() ) {
-		const auto &eventListenerList = found->second;
-		for( auto &listener : eventListenerList ) {
+	const auto found = mEventListeners.find( *event );
+	if( found ) {
+		// Indexing rather than iterators: listeners may append to the list,
+		// reallocating it, or tombstone entries further along. Entries appended
+		// during this dispatch lie past numDelegates and are skipped.
+		const auto &delegates = found->mDelegates;
+		const auto numDelegates = delegates.size();
+		for( size_t i = 0; i < numDelegates; ++i ) {
+			const auto listener = delegates[i];
+			if( listener.empty() || listener.isInline() )
+				continue;
 			LOG_EVENT( "SENDING event " + std::string( event->getName() ) + " to delegate." );
 			listener( event );
 			processed = true;
+			if( mStopOnHandled && event->isHandled() )
+				break;
+		}
+		
+		if( found->mNumBatchListeners > 0 && ! ( mStopOnHandled && event->isHandled() ) ) {
+			dispatchBatch( *found, EventSpan( &event, 1 ) );
+			processed = true;
 		}
 	}
 	mFiringEvent = originalFiringEvent;
@@ -142,20 +227,81 @@ bool EventManager::triggerEvent( EventDataRef event )
 	return processed;
 }
 	
-bool EventManager::queueEvent( EventDataRef event )
+bool EventManager::triggerEvent( const InlineEvent &event )
 {
-	assert( mActiveQueue < NUM_QUEUES );
+	LOG_EVENT( "TRIGGERING inline event: " + to_string( event.getTypeId() ) );
+	const auto originalFiringEvent = mFiringEvent;
+	mFiringEvent = true;
+	
+	const auto found = mEventListeners.find( event.getTypeId() );
+	const auto processed = found && dispatchInline( *found, event );
+	mFiringEvent = originalFiringEvent;
+	
+	if( ! mFiringEvent )
+		consumeAfterListeners();
 	
+	return processed;
+}
+	
+bool EventManager::queueEvent( EventDataRef event )
+{
 	// make sure the event is valid
-	if( ! event )
+	if( ! event ) {
 		LOG_EVENT( "WARNING: Invalid event in queueEvent" );
+		return false;
+	}
 	
 	LOG_EVENT( "QUEUEING event: " + std::string( event->getName() ) );
+	
+	// The listener tables belong to the owner thread, so other producers
+	// can't check for listeners here; drainProducerQueues does it instead.
+	if( mQueueMode == QueueMode::CONCURRENT ) {
+		mConcurrentQueue.push( std::move( event ) );
+		return true;
+	}
+	if( mQueueMode == QueueMode::PER_THREAD ) {
+		auto &producerQueue = getProducerQueue();
+		std::lock_guard<std::mutex> lock( producerQueue.mMutex );
+		producerQueue.mEvents.emplace_back( std::move( event ) );
+		return true;
+	}
+
+	return enqueue( std::move( event ) );
+}
 
-	const auto found = mEventListeners.find( event->getTypeId() );
-	if( found != mEventListeners.end() ) {
-		mQueues[mActiveQueue].emplace_back( std::move( event ) );
-		LOG_EVENT( "QUEUED event: " + std::string( mQueues[mActiveQueue].back()->getName() ) );
+bool EventManager::enqueue( EventDataRef event )
+{
+	const auto found = mEventListeners.find( *event );
+	if( found && found->hasListeners() ) {
+		if( found->mCoalescing ) {
+			const auto &coalescing = *found->mCoalescing;
+			const CoalesceKey key = { found->mType, coalescing.mKey ? coalescing.mKey( *event ) : 0 };
+			const auto inserted = mCoalescedEvents.emplace( key, mQueue.endSequence() );
+			if( ! inserted.second ) {
+				auto &queued = mQueue[inserted.first->second].mEvent;
+				if( coalescing.mMerge ) {
+					queued = coalescing.mMerge( queued, event );
+					assert( ! queued || queued->getTypeId() == found->mType );
+					if( ! queued ) {
+						// Left in place as an aborted entry; the type's mQueued
+						// keeps the sequence until it is skipped.
+						LOG_EVENT( "COALESCED event away: " + std::string( event->getName() ) );
+						mCoalescedEvents.erase( inserted.first );
+						++mNumAbortedEvents;
+						return true;
+					}
+				}
+				else if( coalescing.mPolicy == CoalescePolicy::KEEP_LATEST ) {
+					queued = std::move( event );
+				}
+				LOG_EVENT( "COALESCED event: " + std::string( queued->getName() ) );
+				
+				return true;
+			}
+		}
+		
+		LOG_EVENT( "QUEUED event: " + std::string( event->getName() ) );
+		found->mQueued.push_back( mQueue.push_back( QueuedEvent{ std::move( event ), InlineEvent() } ) );
 
 		return true;
 	}
@@ -168,179 +314,835 @@ bool EventManager::queueEvent( EventDataRef event )
 	
 	return false;
 }
+
+bool EventManager::queueEvent( const InlineEvent &event )
+{
+	if( event.empty() ) {
+		LOG_EVENT( "WARNING: Invalid event in queueEvent" );
+		return false;
+	}
+	
+	const auto found = mEventListeners.find( event.getTypeId() );
+	if( ! found || ! found->hasListeners() ) {
+		LOG_EVENT( "WARNING: Skipping inline event since there are no delegates to receive it: " + to_string( event.getTypeId() ) );
+		return false;
+	}
 	
+	LOG_EVENT( "QUEUED inline event: " + to_string( event.getTypeId() ) );
+	found->mQueued.push_back( mQueue.push_back( QueuedEvent{ EventDataRef(), event } ) );
+	return true;
+}
+
+void EventManager::popQueued( EventListenerList &listeners, EventQueue::Sequence sequence )
+{
+	auto &sequences = listeners.mQueued;
+	while( ! sequences.empty() && sequences.front() < sequence )
+		sequences.pop_front();
+	assert( ! sequences.empty() && sequences.front() == sequence );
+	sequences.pop_front();
+}
+
+void EventManager::drainProducerQueues()
+{
+	if( mQueueMode == QueueMode::CONCURRENT ) {
+		EventDataRef event;
+		while( mConcurrentQueue.pop( event ) )
+			enqueue( std::move( event ) );
+	}
+	else if( mQueueMode == QueueMode::PER_THREAD ) {
+		{
+			std::lock_guard<std::mutex> lock( mProducerQueuesMutex );
+			for( size_t i = 0; i < mProducerQueues.size(); ) {
+				auto &producerQueue = *mProducerQueues[i];
+				// Threads close their queue after their last queueEvent, so a
+				// queue seen closed here is emptied for good by the swap.
+				const bool isClosed = producerQueue.mIsClosed;
+				{
+					std::lock_guard<std::mutex> producerLock( producerQueue.mMutex );
+					std::swap( producerQueue.mEvents, producerQueue.mDrained );
+				}
+				auto &drained = producerQueue.mDrained;
+				std::move( drained.begin(), drained.end(), std::back_inserter( mMergedEvents ) );
+				drained.clear();
+				
+				if( isClosed )
+					mProducerQueues.erase( mProducerQueues.begin() + i );
+				else
+					++i;
+			}
+		}
+		
+		if( mMergeOrder == MergeOrder::TIMESTAMP ) {
+			std::stable_sort( mMergedEvents.begin(), mMergedEvents.end(),
+							 []( const EventDataRef &a, const EventDataRef &b ) {
+								 return a->getTimeStamp() < b->getTimeStamp();
+							 } );
+		}
+		
+		for( auto &event : mMergedEvents )
+			enqueue( std::move( event ) );
+		mMergedEvents.clear();
+	}
+}
+
+EventManager::ProducerQueue& EventManager::getProducerQueue()
+{
+	// Managers are looked up by id rather than address, so entries left behind
+	// by destroyed managers can never be matched again.
+	static thread_local ProducerQueueRegistry sRegistry;
+	auto &queues = sRegistry.mQueues;
+	for( auto &entry : queues ) {
+		if( entry.first == mId )
+			return *entry.second;
+	}
+	
+	// Drop the queues of managers destroyed since the last registration.
+	queues.erase( std::remove_if( queues.begin(), queues.end(),
+								 []( const std::pair<uint64_t, std::shared_ptr<ProducerQueue>> &entry ) { return entry.second->mIsClosed.load(); } ),
+				 queues.end() );
+	
+	auto producerQueue = std::make_shared<ProducerQueue>();
+	{
+		std::lock_guard<std::mutex> lock( mProducerQueuesMutex );
+		mProducerQueues.push_back( producerQueue );
+	}
+	queues.emplace_back( mId, producerQueue );
+	return *producerQueue;
+}
+
+EventManager::ProducerQueueRegistry::~ProducerQueueRegistry()
+{
+	// Whatever the thread queued stays for the manager's next update(),
+	// which then lets go of the queue.
+	for( auto &entry : mQueues )
+		entry.second->mIsClosed = true;
+}
+
 bool EventManager::abortEvent( EventType type, bool allOfType )
 {
-	assert( mActiveQueue >= 0 );
-	assert( mActiveQueue > NUM_QUEUES );
+	drainProducerQueues();
 	
-	auto success = false;
 	const auto found = mEventListeners.find( type );
+	if( ! found )
+		return false;
 	
-	if( found != mEventListeners.end() ) {
-		auto & eventQueue = mQueues[mActiveQueue];
-		auto eventIt = eventQueue.begin();
-		const auto end = eventQueue.end();
-		while( eventIt != end ) {
-			
-			if( (*eventIt)->getTypeId() == type ) {
-				eventIt = eventQueue.erase(eventIt);
-				success = true;
-				if( ! allOfType )
-					break;
-			}
+	// Aborted events are released in place; update() skips the null entry.
+	auto &sequences = found->mQueued;
+	size_t numAborted = 0;
+	while( ! sequences.empty() && ( allOfType || numAborted == 0 ) ) {
+		const auto sequence = sequences.front();
+		sequences.pop_front();
+		
+		// Dropped by a coalescing merge, and possibly popped since.
+		if( ! mQueue.contains( sequence ) )
+			continue;
+		auto &queued = mQueue[sequence];
+		if( ! queued.mEvent ) {
+			if( queued.mInline.empty() )
+				continue;
+			LOG_EVENT( "ABORTED inline event: " + to_string( type ) );
+			queued.mInline.clear();
+			++numAborted;
+			continue;
+		}
+		
+		auto &event = queued.mEvent;
+		if( found->mCoalescing ) {
+			const auto &coalescing = *found->mCoalescing;
+			const CoalesceKey key = { type, coalescing.mKey ? coalescing.mKey( *event ) : 0 };
+			const auto coalesced = mCoalescedEvents.find( key );
+			if( coalesced != mCoalescedEvents.end() && coalesced->second == sequence )
+				mCoalescedEvents.erase( coalesced );
 		}
+		LOG_EVENT( "ABORTED event: " + std::string( event->getName() ) );
+		event.reset();
+		++numAborted;
 	}
+	mNumAbortedEvents += numAborted;
 	
-	return success;
+	return numAborted > 0;
 }
 	
-bool EventManager::addThreadedListener( EventListenerDelegate eventDelegate, EventType type )
+void EventManager::setCoalescing( EventType type, CoalescePolicy policy, CoalesceKeyFn key )
+{
+	std::unique_ptr<Coalescing> coalescing;
+	if( policy != CoalescePolicy::NONE )
+		coalescing.reset( new Coalescing{ policy, CoalesceMergeFn(), std::move( key ) } );
+	setCoalescing( type, std::move( coalescing ) );
+}
+
+void EventManager::setCoalescing( EventType type, CoalesceMergeFn merge, CoalesceKeyFn key )
+{
+	std::unique_ptr<Coalescing> coalescing;
+	if( merge )
+		coalescing.reset( new Coalescing{ CoalescePolicy::KEEP_LATEST, std::move( merge ), std::move( key ) } );
+	setCoalescing( type, std::move( coalescing ) );
+}
+
+void EventManager::setCoalescing( EventType type, std::unique_ptr<Coalescing> coalescing )
+{
+	mEventListeners.getList( type ).mCoalescing = std::move( coalescing );
+	// The keys of already queued events may no longer apply.
+	mCoalescedEvents.clear();
+}
+	
+ListenerHandle EventManager::addThreadedListener( EventListenerDelegate eventDelegate, EventType type, int32_t priority )
+{
+	return insertThreadedListener( Listener( std::move( eventDelegate ) ), type, priority );
+}
+
+ListenerHandle EventManager::addThreadedListener( BorrowedEventListenerDelegate eventDelegate, EventType type, int32_t priority )
+{
+	return insertThreadedListener( Listener( std::move( eventDelegate ) ), type, priority );
+}
+
+ListenerHandle EventManager::addThreadedListener( EventDelegate eventDelegate, EventType type, int32_t priority )
+{
+	return insertThreadedListener( Listener( eventDelegate ), type, priority );
+}
+
+ListenerHandle EventManager::insertThreadedListener( Listener listener, EventType type, int32_t priority )
 {
 	std::lock_guard<std::mutex> lock( mThreadedEventListenerMutex );
 	
-	auto &eventDelegateList = mThreadedEventListeners[type];
-	for( auto &delegate : eventDelegateList ) {
-		if( eventDelegate == delegate ) {
-			LOG_EVENT( "WARNING: Attempting to double-register a delegate" );
-			return false;
-		}
+	const auto handle = mThreadedEventListeners.insert( type, std::move( listener ), priority, true );
+	if( ! handle ) {
+		LOG_EVENT( "WARNING: Attempting to double-register a delegate" );
+		return ListenerHandle();
 	}
-
-	eventDelegateList.emplace_back( std::move( eventDelegate ) );
+	publishThreadedListeners( *mThreadedEventListeners.find( handle ) );
+	
 	LOG_EVENT( "ADDED delegate for event type: " + to_string( type ) );
 
-	return true;
+	return handle;
 }
 
 bool EventManager::removeThreadedListener( EventListenerDelegate eventDelegate, EventType type )
+{
+	return removeThreadedListener( DelegateKey( eventDelegate ), type );
+}
+
+bool EventManager::removeThreadedListener( BorrowedEventListenerDelegate eventDelegate, EventType type )
+{
+	return removeThreadedListener( DelegateKey( eventDelegate ), type );
+}
+
+bool EventManager::removeThreadedListener( EventDelegate eventDelegate, EventType type )
+{
+	return removeThreadedListener( DelegateKey( eventDelegate ), type );
+}
+
+bool EventManager::removeThreadedListener( const DelegateKey &key, EventType type )
 {
 	std::lock_guard<std::mutex> lock( mThreadedEventListenerMutex );
 	
-	auto found = mThreadedEventListeners.find( type );
-	if( found != mThreadedEventListeners.end() ) {
-		auto &listeners = found->second;
-		for( auto listIt = listeners.begin(); listIt != listeners.end(); ++listIt ) {
-			if( eventDelegate == (*listIt) ) {
-				listeners.erase( listIt );
-				LOG_EVENT( "REMOVED delegate function from event type: " << to_string( type ) );
-				return true;
-			}
-		}
+	const auto success = mThreadedEventListeners.remove( mThreadedEventListeners.find( type, key ), true );
+	if( success ) {
+		publishThreadedListeners( *mThreadedEventListeners.find( type ) );
+		LOG_EVENT( "REMOVED delegate function from event type: " << to_string( type ) );
 	}
 
-	return false;
+	return success;
+}
+
+bool EventManager::removeThreadedListener( ListenerHandle handle )
+{
+	std::lock_guard<std::mutex> lock( mThreadedEventListenerMutex );
+	
+	const auto listeners = mThreadedEventListeners.find( handle );
+	if( ! listeners || ! mThreadedEventListeners.remove( handle, true ) )
+		return false;
+	
+	publishThreadedListeners( *listeners );
+	return true;
 }
 
 void EventManager::removeAllThreadedListeners()
 {
 	std::lock_guard<std::mutex> lock( mThreadedEventListenerMutex );
 	mThreadedEventListeners.clear();
+	publishThreadedListeners( std::make_shared<ThreadedListenerSnapshot>() );
 }
 
 bool EventManager::triggerThreadedEvent( EventDataRef event )
 {
-	std::lock_guard<std::mutex> lock( mThreadedEventListenerMutex );
+	// Holding the snapshot keeps its arrays alive for the whole dispatch, even
+	// if a listener is added or removed meanwhile. No lock is held while the
+	// listeners run, so they may trigger further threaded events.
+	uint64_t version;
+	auto snapshot = acquireThreadedListeners( version );
 	
 	auto processed = false;
-	const auto found = mThreadedEventListeners.find( event->getTypeId() );
-	if( found != mThreadedEventListeners.end() ) {
-		const auto &eventListenerList = found->second;
-		for( auto &listener : eventListenerList ) {
+	const auto found = snapshot ? snapshot->find( *event ) : nullptr;
+	if( found ) {
+		for( auto &listener : *found ) {
 			listener( event );
 			processed = true;
+			if( mStopOnHandled && event->isHandled() )
+				break;
 		}
 	}
 
+	releaseThreadedListeners( std::move( snapshot ), version );
+
 	if( ! processed )
 		LOG_EVENT( "WARNING: Triggering ThreadedEvent without a listener" );
 
 	return processed;
 }
 
+EventManager::ThreadedListenerCache& EventManager::getThreadedListenerCache()
+{
+	static thread_local ThreadedListenerCache sCache;
+	return sCache;
+}
+
+std::shared_ptr<const EventManager::ThreadedListenerSnapshot> EventManager::acquireThreadedListeners( uint64_t &version ) const
+{
+	// Pairs with the release increment in publishThreadedListeners: a thread
+	// that sees the old version may still dispatch from the old snapshot,
+	// which removeThreadedListener allows for.
+	version = mThreadedListenerVersion.load( std::memory_order_acquire );
+	auto &cache = getThreadedListenerCache();
+	if( cache.mSnapshot && cache.mManagerId == mId && cache.mVersion == version ) {
+		// Moved out rather than copied so the shared count isn't touched; a
+		// nested triggerThreadedEvent finds the cache empty and refetches.
+		return std::move( cache.mSnapshot );
+	}
+	
+	std::lock_guard<std::mutex> lock( mThreadedEventListenerMutex );
+	version = mThreadedListenerVersion.load( std::memory_order_relaxed );
+	return mThreadedListenerSnapshot;
+}
+
+void EventManager::releaseThreadedListeners( std::shared_ptr<const ThreadedListenerSnapshot> snapshot, uint64_t version ) const
+{
+	// A nested dispatch may have cached a newer snapshot meanwhile.
+	auto &cache = getThreadedListenerCache();
+	if( cache.mSnapshot && cache.mManagerId == mId && cache.mVersion >= version )
+		return;
+	
+	cache.mManagerId = mId;
+	cache.mVersion = version;
+	cache.mSnapshot = std::move( snapshot );
+}
+
+void EventManager::publishThreadedListeners( const EventListenerList &listeners )
+{
+	auto delegates = std::make_shared<ThreadedListenerSnapshot::Delegates>();
+	delegates->reserve( listeners.mDelegates.size() - listeners.mNumTombstones );
+	for( auto &listener : listeners.mDelegates ) {
+		if( ! listener.empty() )
+			delegates->push_back( listener );
+	}
+	
+	auto snapshot = std::make_shared<ThreadedListenerSnapshot>( *mThreadedListenerSnapshot );
+	snapshot->mLists[listeners.mType] = delegates;
+	
+	const auto index = EventTypeRegistry::find( listeners.mType );
+	if( index != kInvalidEventTypeIndex ) {
+		if( index >= snapshot->mListsByIndex.size() )
+			snapshot->mListsByIndex.resize( index + 1, nullptr );
+		snapshot->mListsByIndex[index] = delegates.get();
+	}
+	
+	publishThreadedListeners( std::move( snapshot ) );
+}
+
+void EventManager::publishThreadedListeners( std::shared_ptr<const ThreadedListenerSnapshot> snapshot )
+{
+	mThreadedListenerSnapshot = std::move( snapshot );
+	mThreadedListenerVersion.fetch_add( 1, std::memory_order_release );
+}
+
 void EventManager::consumeAfterListeners()
 {
-	if( ! mAddAfter.empty() ) {
-		std::sort( mAddAfter.begin(), mAddAfter.end(),
-				  []( const pair<EventType, EventListenerDelegate> &a,
-					  const pair<EventType, EventListenerDelegate> &b ) {
-					  return a.first < b.first;
-				  });
-		for( auto &removeEvent : mAddAfter )
-			addListener( removeEvent.second, removeEvent.first );
-		mAddAfter.clear();
+	mEventListeners.compact();
+}
+	
+void EventManager::dispatchBatches()
+{
+	for( auto listeners : mBatchedLists ) {
+		dispatchBatch( *listeners, EventSpan( listeners->mBatch.data(), listeners->mBatch.size() ) );
+		// Keeps its capacity for the next update().
+		listeners->mBatch.clear();
 	}
+	mBatchedLists.clear();
+}
+
+bool EventManager::dispatchInline( const EventListenerList &listeners, const InlineEvent &event )
+{
+	auto processed = false;
+	const auto &delegates = listeners.mDelegates;
+	const auto numDelegates = delegates.size();
+	for( size_t i = 0; i < numDelegates; ++i ) {
+		const auto listener = delegates[i];
+		if( ! listener.isInline() || listener.empty() )
+			continue;
+		listener( event );
+		processed = true;
+	}
+	return processed;
+}
 
-	if( ! mRemoveAfter.empty() ) {
-		std::sort( mRemoveAfter.begin(), mRemoveAfter.end(),
-				  []( const pair<EventType, EventListenerDelegate> &a,
-					  const pair<EventType, EventListenerDelegate> &b ) {
-					  return a.first < b.first;
-				  });
-		for( auto &removeEvent : mRemoveAfter )
-			removeListener( removeEvent.second, removeEvent.first );
-		mRemoveAfter.clear();
+void EventManager::dispatchBatch( const EventListenerList &listeners, const EventSpan &events )
+{
+	// Batch listeners added meanwhile are appended past numListeners.
+	const auto &batchListeners = listeners.mBatchListeners;
+	const auto numListeners = batchListeners.size();
+	for( size_t i = 0; i < numListeners; ++i ) {
+		const auto listener = batchListeners[i].mDelegate;
+		if( ! listener.empty() )
+			listener( events );
 	}
 }
 	
 bool EventManager::update( uint64_t maxMillis )
 {
-	static uint64_t currMs = 0;
-	currMs = (1.0 / 60.0) * 1000;
-	const auto maxMs = maxMillis == EventManager::kINFINITE ? EventManager::kINFINITE : currMs + maxMillis;
+	using Clock = std::chrono::steady_clock;
+	const auto start = Clock::now();
+	const auto hasTimeLimit = maxMillis != EventManager::kINFINITE;
+	const auto deadline = start + std::chrono::milliseconds( hasTimeLimit ? maxMillis : 0 );
+	size_t numProcessed = 0;
+	size_t nextClockCheck = 1;
+	auto timedOut = false;
+	
+	drainProducerQueues();
+	
+	// Events created from here on, listeners included, belong to the next
+	// frame. The arena taking them over held the events of the frame before
+	// last, which have normally all been released by now.
+	mActiveArena ^= 1;
+	if( ! mArenas[mActiveArena]->reset() )
+		LOG_EVENT( "WARNING: Frame events are still referenced; their arena keeps growing" );
 	
 	mFiringEvent = true;
 
-	const int queueToProcess = mActiveQueue;
-	mActiveQueue = ( mActiveQueue + 1 ) % NUM_QUEUES;
-	mQueues[mActiveQueue].clear();
+	// Events queued by listeners from here on wait for the next update().
+	const auto end = mQueue.endSequence();
+	// Events about to be processed are no longer coalescing targets.
+	mCoalescedEvents.clear();
 	
 	static auto processNotify = false;
 	if( ! processNotify ) {
-		LOG_EVENT( "Processing Event Queue " + to_string( queueToProcess ) + "; " + to_string( mQueues[queueToProcess].size() ) + " events to process" );
+		LOG_EVENT( "Processing Event Queue; " + to_string( mQueue.size() ) + " events to process" );
 		processNotify = true;
 	}
 	
-	while( ! mQueues[queueToProcess].empty() ) {
-		const auto event = mQueues[queueToProcess].front();
-		mQueues[queueToProcess].pop_front();
-		LOG_EVENT( "\t\tProcessing Event " + std::string( event->getName() ) );
-		
-		const auto &eventType = event->getTypeId();
+	while( mQueue.beginSequence() != end ) {
+		const auto sequence = mQueue.beginSequence();
+		auto queued = mQueue.pop_front();
+		auto &event = queued.mEvent;
+		if( ! event ) {
+			if( queued.mInline.empty() ) {
+				--mNumAbortedEvents;
+				continue;
+			}
+			
+			const auto found = mEventListeners.find( queued.mInline.getTypeId() );
+			if( found ) {
+				popQueued( *found, sequence );
+				dispatchInline( *found, queued.mInline );
+			}
+		}
+		else if( const auto found = mEventListeners.find( *event ) ) {
+			LOG_EVENT( "\t\tProcessing Event " + std::string( event->getName() ) );
 
-		const auto found = mEventListeners.find( eventType );
-		if( found != mEventListeners.end() ) {
-			const auto &eventListeners = found->second;
-			LOG_EVENT( "\t\tFound " + to_string( eventListeners.size() ) + " delegates" );
+			popQueued( *found, sequence );
+			
+			const auto &delegates = found->mDelegates;
+			LOG_EVENT( "\t\tFound " + to_string( delegates.size() - found->mNumTombstones ) + " delegates" );
 
-			auto listIt = eventListeners.begin();
-			const auto end = eventListeners.end();
-			while( listIt != end ) {
-				const auto listener = (*listIt);
+			const auto numDelegates = delegates.size();
+			for( size_t i = 0; i < numDelegates; ++i ) {
+				const auto listener = delegates[i];
+				if( listener.empty() || listener.isInline() )
+					continue;
 				LOG_EVENT( "\t\tSending Event " + std::string( event->getName() ) + " to delegate" );
 				listener( event );
-				++listIt;
+				if( mStopOnHandled && event->isHandled() ) {
+					LOG_EVENT( "\t\tEvent " + std::string( event->getName() ) + " was handled" );
+					break;
+				}
+			}
+			
+			if( found->mNumBatchListeners > 0 && ! ( mStopOnHandled && event->isHandled() ) ) {
+				if( found->mBatch.empty() )
+					mBatchedLists.push_back( found );
+				found->mBatch.push_back( std::move( event ) );
 			}
 		}
 		
-//		currMs = app::App::get()->getElapsedSeconds() * 1000;//Engine::getTickCount();
-		if( maxMillis != EventManager::kINFINITE && currMs >= maxMs ) {
-			LOG_EVENT( "WARNING: Aborting event processing; time ran out" );
-			break;
+		// Reading the clock costs about as much as a cheap listener, so it is
+		// only read once the events processed since the last read are
+		// expected to have used up a quarter of the remaining time.
+		if( hasTimeLimit && ++numProcessed >= nextClockCheck ) {
+			const auto now = Clock::now();
+			if( now >= deadline ) {
+				LOG_EVENT( "WARNING: Aborting event processing; time ran out" );
+				timedOut = true;
+				break;
+			}
+			
+			const auto costPerEvent = ( now - start ) / numProcessed;
+			size_t interval = kMaxClockCheckInterval;
+			if( costPerEvent.count() > 0 )
+				interval = std::min<size_t>( ( deadline - now ) / 4 / costPerEvent, kMaxClockCheckInterval );
+			nextClockCheck = numProcessed + std::max<size_t>( interval, 1 );
 		}
-	}
-
-	const auto queueFlushed = mQueues[queueToProcess].empty();
-	if( ! queueFlushed ) {
-		while( ! mQueues[queueToProcess].empty() ) {
-			auto event = mQueues[queueToProcess].back();
-			mQueues[queueToProcess].pop_back();
-			mQueues[mActiveQueue].emplace_front( std::move( event ) );
+		else if( ! hasTimeLimit ) {
+			++numProcessed;
 		}
 	}
+
+	// Leftovers are still at the front, ahead of whatever listeners queued.
+	const auto queueFlushed = mQueue.beginSequence() == end;
+	
+	dispatchBatches();
 	
 	mFiringEvent = false;
 	consumeAfterListeners();
 	
+	mLastUpdateStats.mElapsedMillis = std::chrono::duration<double, std::milli>( Clock::now() - start ).count();
+	mLastUpdateStats.mNumProcessed = numProcessed;
+	mLastUpdateStats.mNumRemaining = mQueue.size() - mNumAbortedEvents;
+	mLastUpdateStats.mTimedOut = timedOut;
+	
 	return queueFlushed;
 }
+
+EventManager::ListenerTable::ListenerTable()
+	: mId( sNextListenerTableId++ )
+{
+}
+
+ListenerHandle EventManager::ListenerTable::insert( EventType type, Listener listener, int32_t priority, bool allowReorder )
+{
+	auto &listeners = getList( type );
+	const auto index = acquire( listeners, listener.key(), false );
+	if( index == kNoSlot )
+		return ListenerHandle();
+	
+	auto &slot = mSlots[index];
+	
+	auto &priorities = listeners.mPriorities;
+	if( priorities.empty() || priorities.back() >= priority || ! allowReorder ) {
+		if( ! priorities.empty() && priorities.back() < priority ) {
+			listeners.mIsUnsorted = true;
+			markDirty( listeners );
+		}
+		slot.mPosition = static_cast<uint32_t>( listeners.mDelegates.size() );
+		listeners.mDelegates.emplace_back( std::move( listener ) );
+		listeners.mSlots.push_back( index );
+		priorities.push_back( priority );
+		return ListenerHandle( index, slot.mGeneration, mId );
+	}
+	
+	// Goes in front of the first listener with a lower priority.
+	const auto position = static_cast<uint32_t>( std::upper_bound( priorities.begin(), priorities.end(), priority, std::greater<int32_t>() ) - priorities.begin() );
+	listeners.mDelegates.insert( listeners.mDelegates.begin() + position, std::move( listener ) );
+	listeners.mSlots.insert( listeners.mSlots.begin() + position, index );
+	priorities.insert( priorities.begin() + position, priority );
+	for( auto i = position; i < listeners.mSlots.size(); ++i ) {
+		if( listeners.mSlots[i] != kNoSlot )
+			mSlots[listeners.mSlots[i]].mPosition = i;
+	}
+	return ListenerHandle( index, slot.mGeneration, mId );
+}
+
+ListenerHandle EventManager::ListenerTable::insert( EventType type, EventBatchListenerDelegate delegate, int32_t priority, bool allowReorder )
+{
+	auto &listeners = getList( type );
+	const auto index = acquire( listeners, DelegateKey( delegate ), true );
+	if( index == kNoSlot )
+		return ListenerHandle();
+	
+	auto &batchListeners = listeners.mBatchListeners;
+	auto position = static_cast<uint32_t>( batchListeners.size() );
+	if( ! batchListeners.empty() && batchListeners.back().mPriority < priority ) {
+		if( allowReorder ) {
+			position = static_cast<uint32_t>( std::upper_bound( batchListeners.begin(), batchListeners.end(), priority,
+															   []( int32_t priority, const BatchListener &listener ) { return priority > listener.mPriority; } ) - batchListeners.begin() );
+		}
+		else {
+			listeners.mIsUnsorted = true;
+			markDirty( listeners );
+		}
+	}
+	
+	batchListeners.insert( batchListeners.begin() + position, BatchListener{ std::move( delegate ), priority, index } );
+	for( auto i = position; i < batchListeners.size(); ++i ) {
+		if( batchListeners[i].mSlot != kNoSlot )
+			mSlots[batchListeners[i].mSlot].mPosition = i;
+	}
+	++listeners.mNumBatchListeners;
+	return ListenerHandle( index, mSlots[index].mGeneration, mId );
+}
+
+bool EventManager::ListenerTable::remove( ListenerHandle handle, bool allowCompaction )
+{
+	auto slot = resolve( handle );
+	if( ! slot )
+		return false;
+	
+	// Leave a tombstone so a running dispatch keeps its positions.
+	auto listeners = slot->mList;
+	if( slot->mIsBatch ) {
+		auto &batchListener = listeners->mBatchListeners[slot->mPosition];
+		listeners->mIndex.erase( DelegateKey( batchListener.mDelegate ) );
+		batchListener.mDelegate.clear();
+		batchListener.mSlot = kNoSlot;
+		--listeners->mNumBatchListeners;
+		markDirty( *listeners );
+		release( handle.getIndex() );
+		return true;
+	}
+	
+	auto &delegate = listeners->mDelegates[slot->mPosition];
+	listeners->mIndex.erase( delegate.key() );
+	delegate.clear();
+	// The slot goes back on the free list, so the tombstone mustn't keep
+	// pointing at whichever listener claims it next.
+	listeners->mSlots[slot->mPosition] = kNoSlot;
+	++listeners->mNumTombstones;
+	markDirty( *listeners );
+	release( handle.getIndex() );
+	
+	// Compact early once tombstones make up half the list, so repeated add /
+	// remove cycles outside of dispatch can't grow it without bound.
+	if( allowCompaction && listeners->mNumTombstones * 2 >= listeners->mDelegates.size() )
+		compact( *listeners );
+	
+	return true;
+}
+
+ListenerHandle EventManager::ListenerTable::find( EventType type, const DelegateKey &key ) const
+{
+	auto listeners = mLists.find( type );
+	if( listeners ) {
+		const auto found = listeners->mIndex.find( key );
+		if( found != listeners->mIndex.end() )
+			return ListenerHandle( found->second, mSlots[found->second].mGeneration, mId );
+	}
+	
+	return ListenerHandle();
+}
+
+EventManager::EventListenerList& EventManager::ListenerTable::getList( EventType type )
+{
+	auto &listeners = mLists[type];
+	listeners.mType = type;
+	return listeners;
+}
+
+const EventManager::EventListenerList* EventManager::ListenerTable::find( ListenerHandle handle )
+{
+	auto slot = resolve( handle );
+	return slot ? slot->mList : nullptr;
+}
+
+EventManager::EventListenerList* EventManager::ListenerTable::find( const EventData &event )
+{
+	const auto index = event.getTypeIndex();
+	if( index == kInvalidEventTypeIndex )
+		return mLists.find( event.getTypeId() );
+	
+	if( index < mListsByIndex.size() && mListsByIndex[index] )
+		return mListsByIndex[index];
+	
+	// First event of this type since its list was created; remember where the
+	// list lives so the next lookup is a single array access.
+	auto listeners = mLists.find( event.getTypeId() );
+	if( listeners ) {
+		if( index >= mListsByIndex.size() )
+			mListsByIndex.resize( index + 1, nullptr );
+		mListsByIndex[index] = listeners;
+	}
+	return listeners;
+}
+
+void EventManager::ListenerTable::compact()
+{
+	for( auto listeners : mDirtyLists ) {
+		compact( *listeners );
+		if( listeners->mIsUnsorted )
+			sort( *listeners );
+		listeners->mIsDirty = false;
+	}
+	mDirtyLists.clear();
+}
+
+void EventManager::ListenerTable::clear()
+{
+	for( uint32_t index = 0; index < mSlots.size(); ++index ) {
+		if( mSlots[index].mInUse )
+			release( index );
+	}
+	mDirtyLists.clear();
+	mListsByIndex.clear();
+	mLists.clear();
+}
+
+EventManager::ListenerTable::Slot* EventManager::ListenerTable::resolve( ListenerHandle handle )
+{
+	if( ! handle || handle.getTable() != mId || handle.getIndex() >= mSlots.size() )
+		return nullptr;
+	
+	auto &slot = mSlots[handle.getIndex()];
+	if( ! slot.mInUse || slot.mGeneration != handle.getGeneration() )
+		return nullptr;
+	
+	return &slot;
+}
+
+uint32_t EventManager::ListenerTable::acquire( EventListenerList &listeners, const DelegateKey &key, bool isBatch )
+{
+	uint32_t index;
+	if( ! mFreeSlots.empty() ) {
+		index = mFreeSlots.back();
+		mFreeSlots.pop_back();
+	}
+	else {
+		index = static_cast<uint32_t>( mSlots.size() );
+		mSlots.emplace_back();
+	}
+	
+	auto &slot = mSlots[index];
+	slot.mInUse = true;
+	if( ! listeners.mIndex.emplace( key, index ).second ) {
+		release( index );
+		return kNoSlot;
+	}
+	
+	slot.mList = &listeners;
+	slot.mIsBatch = isBatch;
+	return index;
+}
+
+void EventManager::ListenerTable::markDirty( EventListenerList &listeners )
+{
+	if( ! listeners.mIsDirty ) {
+		listeners.mIsDirty = true;
+		mDirtyLists.push_back( &listeners );
+	}
+}
+
+void EventManager::ListenerTable::release( uint32_t index )
+{
+	auto &slot = mSlots[index];
+	slot.mInUse = false;
+	slot.mList = nullptr;
+	++slot.mGeneration;
+	mFreeSlots.push_back( index );
+}
+
+void EventManager::ListenerTable::compact( EventListenerList &listeners )
+{
+	// Stable, so registration order survives compaction.
+	auto &batchListeners = listeners.mBatchListeners;
+	if( listeners.mNumBatchListeners < batchListeners.size() ) {
+		batchListeners.erase( std::remove_if( batchListeners.begin(), batchListeners.end(),
+											 []( const BatchListener &listener ) { return listener.mDelegate.empty(); } ),
+							 batchListeners.end() );
+		for( uint32_t i = 0; i < batchListeners.size(); ++i )
+			mSlots[batchListeners[i].mSlot].mPosition = i;
+	}
+	
+	if( listeners.mNumTombstones == 0 )
+		return;
+	
+	auto &delegates = listeners.mDelegates;
+	auto &slots = listeners.mSlots;
+	auto &priorities = listeners.mPriorities;
+	uint32_t live = 0;
+	for( size_t i = 0; i < delegates.size(); ++i ) {
+		if( delegates[i].empty() )
+			continue;
+		if( live != i ) {
+			delegates[live] = delegates[i];
+			slots[live] = slots[i];
+			priorities[live] = priorities[i];
+		}
+		mSlots[slots[live]].mPosition = live;
+		++live;
+	}
+	delegates.resize( live );
+	slots.resize( live );
+	priorities.resize( live );
+	listeners.mNumTombstones = 0;
+}
+
+void EventManager::ListenerTable::sort( EventListenerList &listeners )
+{
+	// Everything appended while firing was registered after the entries in
+	// front of it, so a stable sort on priority alone restores the order
+	// insert() would have produced.
+	auto &batchListeners = listeners.mBatchListeners;
+	std::stable_sort( batchListeners.begin(), batchListeners.end(),
+					 []( const BatchListener &a, const BatchListener &b ) { return a.mPriority > b.mPriority; } );
+	for( uint32_t i = 0; i < batchListeners.size(); ++i )
+		mSlots[batchListeners[i].mSlot].mPosition = i;
+	listeners.mIsUnsorted = false;
+	
+	if( std::is_sorted( listeners.mPriorities.begin(), listeners.mPriorities.end(), std::greater<int32_t>() ) )
+		return;
+	
+	const auto size = listeners.mDelegates.size();
+	std::vector<uint32_t> order( size );
+	for( uint32_t i = 0; i < size; ++i )
+		order[i] = i;
+	const auto &priorities = listeners.mPriorities;
+	std::stable_sort( order.begin(), order.end(), [&priorities]( uint32_t a, uint32_t b ) { return priorities[a] > priorities[b]; } );
+	
+	std::vector<Listener> delegates( size );
+	std::vector<uint32_t> slots( size );
+	std::vector<int32_t> sortedPriorities( size );
+	for( uint32_t i = 0; i < size; ++i ) {
+		delegates[i] = listeners.mDelegates[order[i]];
+		slots[i] = listeners.mSlots[order[i]];
+		sortedPriorities[i] = priorities[order[i]];
+		mSlots[slots[i]].mPosition = i;
+	}
+	listeners.mDelegates.swap( delegates );
+	listeners.mSlots.swap( slots );
+	listeners.mPriorities.swap( sortedPriorities );
+}
+
+namespace {
+	//! DelegateMemento keeps its fields protected, so hashing them takes a
+	//! subclass.
+	struct ClosureFields : public fastdelegate::DelegateMemento {
+		explicit ClosureFields( const fastdelegate::DelegateMemento &closure ) : DelegateMemento( closure ) {}
+		
+		size_t hash() const
+		{
+			// Mix the bytes of the member function pointer with the object
+			// pointer, mirroring the fields IsEqual looks at.
+			uint64_t hash = 14695981039346656037ULL;
+			const auto bytes = reinterpret_cast<const unsigned char*>( &m_pFunction );
+			for( size_t i = 0; i < sizeof( m_pFunction ); ++i )
+				hash = ( hash ^ bytes[i] ) * 1099511628211ULL;
+#if defined(FASTDELEGATE_USESTATICFUNCTIONHACK)
+			hash = ( hash ^ reinterpret_cast<uintptr_t>( m_pthis ) ) * 1099511628211ULL;
+#else
+			hash = ( hash ^ reinterpret_cast<uintptr_t>( m_pStaticFunction ) ) * 1099511628211ULL;
+#endif
+			return static_cast<size_t>( hash ^ ( hash >> 32 ) );
+		}
+	};
+}
+
+size_t EventManager::DelegateKey::hash() const
+{
+	return mIsDelegate ? mDelegate.hash() : ClosureFields( mClosure ).hash();
+}
+
+const EventManager::ThreadedListenerSnapshot::Delegates* EventManager::ThreadedListenerSnapshot::find( const EventData &event ) const
+{
+	const auto index = event.getTypeIndex();
+	if( index != kInvalidEventTypeIndex && index < mListsByIndex.size() && mListsByIndex[index] )
+		return mListsByIndex[index];
+	
+	const auto found = mLists.find( event.getTypeId() );
+	return found ? found->get() : nullptr;
+}
@@ -44,60 +44,734 @@
 #pragma warning( pop )
 
 #include "EventManagerBase.h"
+#include "FlatEventMap.h"
+#include "ConcurrentEventQueue.h"
+#include "EventRingBuffer.h"
+#include "EventArena.h"
+#include "InlineEvent.h"
+#include "Delegate.h"
 
 #include <vector>
-#include <deque>
-#include <map>
-#include <array>
-#include <list>
+#include <cassert>
+#include <type_traits>
+#include <functional>
+#include <unordered_map>
 #include <atomic>
 #include <mutex>
+#include <new>
 	
-const uint32_t NUM_QUEUES = 2u;
 using EventManagerRef = std::shared_ptr<class EventManager>;
+
+//! Contiguous run of events of one type, handed to batch listeners. Only
+//! valid for the duration of the call.
+class EventSpan {
+public:
+	EventSpan( const EventDataRef *events, size_t size ) : mBegin( events ), mEnd( events + size ) {}
+	
+	const EventDataRef* begin() const { return mBegin; }
+	const EventDataRef* end() const { return mEnd; }
+	size_t size() const { return static_cast<size_t>( mEnd - mBegin ); }
+	bool empty() const { return mBegin == mEnd; }
+	const EventDataRef& operator[]( size_t index ) const { return mBegin[index]; }
+	
+private:
+	const EventDataRef	*mBegin;
+	const EventDataRef	*mEnd;
+};
+using EventBatchListenerDelegate = fastdelegate::FastDelegate1<const EventSpan&, void>;
+//! Listener that borrows the event like BorrowedEventListenerDelegate, but
+//! can also hold a small capturing lambda. Removal takes an equal delegate,
+//! see Delegate::operator==.
+using EventDelegate = Delegate<void( const EventData& )>;
 	
 class EventManager : public EventManagerBase {
-	using EventListenerList = std::list<EventListenerDelegate>;
-	using EventListenerMap	= std::map<EventType, EventListenerList>;
-	using EventQueue		= std::deque<EventDataRef>;
+	//! Hashable identity of a delegate: the same object / member function
+	//! pair that FastDelegate's operator== compares, or for an EventDelegate
+	//! whatever its operator== compares. Only one of the two is stored.
+	struct DelegateKey {
+		template<typename FastDelegateType>
+		explicit DelegateKey( const FastDelegateType &delegate )
+			: DelegateKey( const_cast<FastDelegateType&>( delegate ).GetMemento() ) {}
+		explicit DelegateKey( const fastdelegate::DelegateMemento &closure )
+			: mClosure( closure ), mIsDelegate( false ) {}
+		explicit DelegateKey( const EventDelegate &delegate )
+			: mDelegate( delegate ), mIsDelegate( true ) {}
+		DelegateKey( const DelegateKey &other ) : mIsDelegate( other.mIsDelegate ) { copy( other ); }
+		DelegateKey& operator=( const DelegateKey &other )
+		{
+			if( this != &other ) {
+				mIsDelegate = other.mIsDelegate;
+				copy( other );
+			}
+			return *this;
+		}
+		
+		bool operator==( const DelegateKey &other ) const
+		{
+			if( mIsDelegate != other.mIsDelegate )
+				return false;
+			return mIsDelegate ? mDelegate == other.mDelegate : mClosure.IsEqual( other.mClosure );
+		}
+		size_t hash() const;
+		
+		union {
+			fastdelegate::DelegateMemento	mClosure;
+			EventDelegate					mDelegate;
+		};
+		bool	mIsDelegate;
+		
+	private:
+		void copy( const DelegateKey &other )
+		{
+			if( other.mIsDelegate )
+				new( &mDelegate ) EventDelegate( other.mDelegate );
+			else
+				new( &mClosure ) fastdelegate::DelegateMemento( other.mClosure );
+		}
+	};
+	struct DelegateKeyHash {
+		size_t operator()( const DelegateKey &key ) const { return key.hash(); }
+	};
+	
+	struct Coalescing;
+	
+	//! Result type of the free function overloads, which only take plain
+	//! function pointers. Deduction doesn't apply conversions, so lambdas
+	//! still go to the EventDelegate overloads.
+	template<typename Function, typename Result>
+	using IfFreeFunction = typename std::enable_if<std::is_same<Function, void (*)( const EventData& )>::value, Result>::type;
+	
+	//! A listener of any signature, stored as the closure every FastDelegate
+	//! type wraps, or as an EventDelegate, so that one array keeps them in
+	//! priority order. The two share storage; mInvoke tells them apart.
+	//! Listeners that don't take an EventDataRef carry a thunk that restores
+	//! their delegate's argument type.
+	struct Listener {
+		//! Calls the delegate in \a listener with \a event, an EventData or
+		//! an InlineEvent depending on the listener.
+		using Invoker = void (*)( const Listener &listener, const void *event );
+		
+		Listener() : mClosure(), mInvoke( nullptr ), mIsInline( false ) {}
+		explicit Listener( EventListenerDelegate delegate ) : mClosure( delegate.GetMemento() ), mInvoke( nullptr ), mIsInline( false ) {}
+		explicit Listener( BorrowedEventListenerDelegate delegate ) : Listener( makeTyped( delegate ) ) {}
+		explicit Listener( EventDelegate delegate ) : mDelegate( delegate ), mInvoke( &invokeDelegate ), mIsInline( false ) {}
+		Listener( const Listener &other ) : mInvoke( other.mInvoke ), mIsInline( other.mIsInline ) { copy( other ); }
+		Listener& operator=( const Listener &other )
+		{
+			if( this != &other ) {
+				mInvoke = other.mInvoke;
+				mIsInline = other.mIsInline;
+				copy( other );
+			}
+			return *this;
+		}
+		//! Listener for events of EventData subclass T, which must be the
+		//! class of every event of the type it is registered for.
+		template<typename T>
+		static Listener makeTyped( fastdelegate::FastDelegate1<const T&, void> delegate )
+		{
+			static_assert( std::is_base_of<EventData, T>::value, "typed listeners take EventData subclasses; use addInlineListener for payloads" );
+			return Listener( delegate.GetMemento(), &invokeTyped<T>, false );
+		}
+		//! Listener for InlineEvent payloads of type T.
+		template<typename T>
+		static Listener makeInline( fastdelegate::FastDelegate1<const T&, void> delegate )
+		{
+			return Listener( delegate.GetMemento(), &invokeInline<T>, true );
+		}
+		
+		bool empty() const { return isDelegate() ? mDelegate.empty() : mClosure.empty(); }
+		//! Empties the delegate but keeps its kind, so tombstones stay valid.
+		void clear()
+		{
+			if( isDelegate() )
+				mDelegate.clear();
+			else
+				mClosure.clear();
+		}
+		bool isInline() const { return mIsInline; }
+		bool isDelegate() const { return mInvoke == &invokeDelegate; }
+		DelegateKey key() const { return isDelegate() ? DelegateKey( mDelegate ) : DelegateKey( mClosure ); }
+		
+		void operator()( const EventDataRef &event ) const
+		{
+			if( mInvoke ) {
+				mInvoke( *this, event.get() );
+			}
+			else {
+				EventListenerDelegate delegate;
+				delegate.SetMemento( mClosure );
+				delegate( event );
+			}
+		}
+		void operator()( const InlineEvent &event ) const { mInvoke( *this, &event ); }
+		
+		union {
+			fastdelegate::DelegateMemento	mClosure;
+			//! Used instead of mClosure when mInvoke is invokeDelegate.
+			EventDelegate					mDelegate;
+		};
+		//! Null for delegates taking an EventDataRef.
+		Invoker							mInvoke;
+		bool							mIsInline;
+		
+	private:
+		Listener( const fastdelegate::DelegateMemento &closure, Invoker invoke, bool isInline ) : mClosure( closure ), mInvoke( invoke ), mIsInline( isInline ) {}
+		
+		void copy( const Listener &other )
+		{
+			if( other.isDelegate() )
+				new( &mDelegate ) EventDelegate( other.mDelegate );
+			else
+				new( &mClosure ) fastdelegate::DelegateMemento( other.mClosure );
+		}
+		
+		template<typename T>
+		static void invokeTyped( const Listener &listener, const void *event )
+		{
+			// The type id matched, which is what registering for it promised.
+			const auto &data = *static_cast<const EventData*>( event );
+			assert( dynamic_cast<const T*>( &data ) );
+			fastdelegate::FastDelegate1<const T&, void> delegate;
+			delegate.SetMemento( listener.mClosure );
+			delegate( static_cast<const T&>( data ) );
+		}
+		template<typename T>
+		static void invokeInline( const Listener &listener, const void *event )
+		{
+			// get() asserts that the payload has the size of a T; the type id
+			// matched, which is what registering for it promised.
+			fastdelegate::FastDelegate1<const T&, void> delegate;
+			delegate.SetMemento( listener.mClosure );
+			delegate( static_cast<const InlineEvent*>( event )->get<T>() );
+		}
+		static void invokeDelegate( const Listener &listener, const void *event )
+		{
+			listener.mDelegate( *static_cast<const EventData*>( event ) );
+		}
+	};
+	
+	//! Slot of the event queue, holding either kind of event. Aborted events
+	//! leave both empty.
+	struct QueuedEvent {
+		EventDataRef	mEvent;
+		InlineEvent		mInline;
+	};
+	using EventQueue = RingBuffer<QueuedEvent>;
+	
+	struct BatchListener {
+		EventBatchListenerDelegate	mDelegate;
+		int32_t						mPriority;
+		//! ListenerTable::kNoSlot once removed.
+		uint32_t					mSlot;
+	};
+	
+	//! Listeners for a single event type, packed so dispatch is a linear scan.
+	//! Removing a listener clears its delegate in place, leaving a tombstone
+	//! that dispatch skips; tombstones are only compacted away while no event
+	//! is being fired, so positions never shift under a running iteration.
+	//! For the same reason listeners added while firing are appended, and a
+	//! dispatch stops at the size the list had when it started.
+	struct EventListenerList {
+		EventListenerList() : mType( 0 ), mNumTombstones( 0 ), mNumBatchListeners( 0 ), mIsDirty( false ), mIsUnsorted( false ) {}
+		EventType							mType;
+		std::vector<Listener>				mDelegates;
+		//! Handle slot of each entry, parallel to mDelegates so the hot array
+		//! stays dense. Compaction uses it to keep the slots' positions current.
+		//! Tombstones hold ListenerTable::kNoSlot, since their slot was freed.
+		std::vector<uint32_t>				mSlots;
+		//! Priority of each entry, parallel to mDelegates and non-increasing,
+		//! so dispatch order is settled at registration. Appending while firing
+		//! may break the order until the list is next compacted.
+		std::vector<int32_t>				mPriorities;
+		//! Slot of every live delegate, for constant time duplicate checks
+		//! and delegate-based removal.
+		std::unordered_map<DelegateKey, uint32_t, DelegateKeyHash>	mIndex;
+		//! Set by setCoalescing, null for types that queue every event.
+		std::unique_ptr<Coalescing>			mCoalescing;
+		//! Sequences of this type's queued events, oldest first, so aborting
+		//! them doesn't have to scan the queue. Events dropped by a coalescing
+		//! merge leave their sequence behind until update() or abortEvent()
+		//! comes across it.
+		RingBuffer<EventQueue::Sequence>		mQueued;
+		//! Listeners that take all of the type's events of an update() at
+		//! once, ordered and tombstoned like mDelegates.
+		std::vector<BatchListener>			mBatchListeners;
+		//! Events dispatched by the running update(), for mBatchListeners.
+		std::vector<EventDataRef>			mBatch;
+		uint32_t							mNumTombstones;
+		//! Live entries in mBatchListeners.
+		uint32_t							mNumBatchListeners;
+		bool								mIsDirty;
+		//! Set when an entry was appended out of priority order.
+		bool								mIsUnsorted;
+		
+		bool hasListeners() const { return mDelegates.size() > mNumTombstones || mNumBatchListeners > 0; }
+	};
+	
+	//! Owns every EventListenerList of one kind along with the slot table that
+	//! backs ListenerHandles. A slot records which list and position its
+	//! listener occupies, so removing by handle is a direct lookup.
+	class ListenerTable {
+	public:
+		ListenerTable();
+		ListenerTable( const ListenerTable& ) = delete;
+		ListenerTable& operator=( const ListenerTable& ) = delete;
+		
+		//! Registers \a delegate in the \a type list, after every listener of
+		//! equal or higher \a priority. Unless \a allowReorder is set the entry
+		//! is appended instead and the list sorted on the next compact(), so a
+		//! running dispatch never sees its positions shift. Returns an invalid
+		//! handle if the delegate is already registered for \a type.
+		ListenerHandle insert( EventType type, Listener listener, int32_t priority, bool allowReorder );
+		//! As above, for a batch listener.
+		ListenerHandle insert( EventType type, EventBatchListenerDelegate delegate, int32_t priority, bool allowReorder );
+		//! Removes the listener behind \a handle. Tombstones left behind are
+		//! compacted right away if \a allowCompaction is set and at least half
+		//! of the list is dead, otherwise on the next compact().
+		bool remove( ListenerHandle handle, bool allowCompaction );
+		//! Looks up the handle of the delegate identified by \a key in the
+		//! \a type list.
+		ListenerHandle find( EventType type, const DelegateKey &key ) const;
+		//! Returns the list \a handle's listener lives in, or nullptr if the
+		//! handle is stale.
+		const EventListenerList* find( ListenerHandle handle );
+		
+		EventListenerList* find( EventType type ) { return mLists.find( type ); }
+		//! Returns the \a type list, creating an empty one if needed.
+		EventListenerList& getList( EventType type );
+		const EventListenerList* find( EventType type ) const { return mLists.find( type ); }
+		//! Looks up the listeners for \a event. Events with a dense type index
+		//! resolve through a plain array, everything else through the hash table.
+		EventListenerList* find( const EventData &event );
+		
+		//! Squeezes tombstones out of every list that has them and restores
+		//! the priority order of lists appended to while firing. Must not be
+		//! called while one of the lists is being iterated.
+		void compact();
+		//! Removes every listener. Outstanding handles become stale.
+		void clear();
+		
+	private:
+		struct Slot {
+			Slot() : mList( nullptr ), mPosition( 0 ), mGeneration( 0 ), mInUse( false ), mIsBatch( false ) {}
+			EventListenerList	*mList;
+			uint32_t			mPosition;
+			uint32_t			mGeneration;
+			bool				mInUse;
+			//! Whether mPosition indexes mBatchListeners rather than mDelegates.
+			bool				mIsBatch;
+		};
+		
+		Slot* resolve( ListenerHandle handle );
+		//! Claims a slot for \a key in \a listeners, or returns kNoSlot if the
+		//! delegate is already registered there.
+		uint32_t acquire( EventListenerList &listeners, const DelegateKey &key, bool isBatch );
+		void release( uint32_t index );
+		void compact( EventListenerList &listeners );
+		void sort( EventListenerList &listeners );
+		void markDirty( EventListenerList &listeners );
+		
+		static const uint32_t			kNoSlot = 0xffffffff;
+		
+		//! Stamped into every handle this table issues.
+		const uint32_t					mId;
+		FlatEventMap<EventListenerList>	mLists;
+		//! Lists by EventTypeIndex, filled in on first lookup.
+		std::vector<EventListenerList*>	mListsByIndex;
+		std::vector<Slot>				mSlots;
+		std::vector<uint32_t>			mFreeSlots;
+		std::vector<EventListenerList*>	mDirtyLists;
+	};
+	
+	//! Immutable copy of the live threaded listeners. Writers publish a fresh
+	//! snapshot with the affected type's array rebuilt and every other array
+	//! shared, and bump mThreadedListenerVersion. Each thread caches the last
+	//! snapshot it dispatched from, so triggerThreadedEvent only has to read
+	//! the version to know the cache is current: as long as no listener
+	//! changes, it takes no lock and writes to no shared memory.
+	struct ThreadedListenerSnapshot {
+		using Delegates = std::vector<Listener>;
+		
+		const Delegates* find( const EventData &event ) const;
+		
+		FlatEventMap<std::shared_ptr<const Delegates>>	mLists;
+		//! Arrays by EventTypeIndex, for types registered when published.
+		std::vector<const Delegates*>					mListsByIndex;
+	};
+	
+	//! The snapshot a thread last dispatched threaded events from. A single
+	//! entry, so a thread alternating between managers refetches each time,
+	//! but never keeps more than one stale snapshot alive.
+	struct ThreadedListenerCache {
+		ThreadedListenerCache() : mManagerId( 0 ), mVersion( 0 ) {}
+		uint64_t										mManagerId;
+		uint64_t										mVersion;
+		std::shared_ptr<const ThreadedListenerSnapshot>	mSnapshot;
+	};
+	
+	//! Identifies the queued event a new one may be coalesced into.
+	struct CoalesceKey {
+		bool operator==( const CoalesceKey &other ) const { return mType == other.mType && mKey == other.mKey; }
+		EventType	mType;
+		uint64_t	mKey;
+	};
+	struct CoalesceKeyHash {
+		size_t operator()( const CoalesceKey &key ) const { return std::hash<uint64_t>()( key.mType ^ ( key.mKey * 0x9e3779b97f4a7c15ULL ) ); }
+	};
+	
+	//! Events queued by one thread in QueueMode::PER_THREAD. Its mutex is only
+	//! ever contended by the swap in drainProducerQueues, once per update().
+	//! Shared by the manager and the thread, and closed by whichever of the
+	//! two goes away first so the other one drops it.
+	struct ProducerQueue {
+		ProducerQueue() : mIsClosed( false ) {}
+		std::mutex					mMutex;
+		std::vector<EventDataRef>	mEvents;
+		//! Swapped with mEvents on drain, so both keep their capacity.
+		std::vector<EventDataRef>	mDrained;
+		std::atomic<bool>			mIsClosed;
+	};
+	//! The producer queues of one thread, by manager id. Closes them when
+	//! the thread exits, so update() stops draining them once their last
+	//! events have been taken.
+	struct ProducerQueueRegistry {
+		~ProducerQueueRegistry();
+		std::vector<std::pair<uint64_t, std::shared_ptr<ProducerQueue>>>	mQueues;
+	};
 	
 public:
-	static auto create( std::string name, bool setAsGlobal )
+	//! Selects which threads may call queueEvent.
+	enum class QueueMode {
+		//! queueEvent may only be called from the thread that calls update().
+		MAIN_THREAD,
+		//! queueEvent may be called from any thread without locking. Events go
+		//! through a lock-free queue that update() drains on the owner thread.
+		CONCURRENT,
+		//! queueEvent may be called from any thread. Each thread appends to its
+		//! own buffer and update() swaps every buffer out in one batch, merging
+		//! them according to the Format's MergeOrder.
+		PER_THREAD
+	};
+	
+	//! How QueueMode::PER_THREAD combines the buffers of several threads.
+	enum class MergeOrder {
+		//! Each thread's events in the order it queued them, thread by thread.
+		PER_THREAD_FIFO,
+		//! All events ordered by EventData::getTimeStamp(). Events with equal
+		//! timestamps keep their per-thread order.
+		TIMESTAMP
+	};
+	
+	class Format {
+	public:
+		Format() : mQueueMode( QueueMode::MAIN_THREAD ), mMergeOrder( MergeOrder::PER_THREAD_FIFO ), mStopOnHandled( false ), mSingleThreaded( false ) {}
+		
+		Format& queueMode( QueueMode mode ) { mQueueMode = mode; return *this; }
+		QueueMode getQueueMode() const { return mQueueMode; }
+		
+		Format& mergeOrder( MergeOrder order ) { mMergeOrder = order; return *this; }
+		MergeOrder getMergeOrder() const { return mMergeOrder; }
+		
+		//! When enabled, dispatch of an event stops with the first listener
+		//! that marks it with EventData::setIsHandled(). Listeners registered
+		//! after that one don't see the event.
+		Format& stopOnHandled( bool stop = true ) { mStopOnHandled = stop; return *this; }
+		bool getStopOnHandled() const { return mStopOnHandled; }
+		
+		//! Promises that events made by createEvent() and createFrameEvent()
+		//! are only ever referenced on the thread that calls update(). With
+		//! CINDER_EVENTMANAGER_INTRUSIVE_REFS their reference counts then use
+		//! plain increments instead of atomic ones. Requires
+		//! QueueMode::MAIN_THREAD and no threaded listeners for those events.
+		Format& singleThreaded( bool singleThreaded = true ) { mSingleThreaded = singleThreaded; return *this; }
+		bool isSingleThreaded() const { return mSingleThreaded; }
+		
+	private:
+		QueueMode	mQueueMode;
+		MergeOrder	mMergeOrder;
+		bool		mStopOnHandled;
+		bool		mSingleThreaded;
+	};
+	
+	//! What queueEvent does with an event whose type (and key) is already
+	//! waiting in the queue.
+	enum class CoalescePolicy {
+		//! Queue every event.
+		NONE,
+		//! Replace the queued event with the new one, keeping its place.
+		KEEP_LATEST,
+		//! Drop the new event.
+		KEEP_FIRST
+	};
+	//! Combines the \a queued event with an \a incoming one of the same type
+	//! and key. The result takes the queued event's place and must be of the
+	//! same type; returning null drops both events, as if aborted.
+	using CoalesceMergeFn	= std::function<EventDataRef( const EventDataRef &queued, const EventDataRef &incoming )>;
+	//! Splits a type into independently coalesced streams, e.g. per entity.
+	using CoalesceKeyFn		= std::function<uint64_t( const EventData &event )>;
+	
+	static auto create( std::string name, bool setAsGlobal, const Format &format = Format() )
 	{
-		return EventManagerRef( new EventManager( std::move( name ), setAsGlobal ) );
+		return EventManagerRef( new EventManager( std::move( name ), setAsGlobal, format ) );
 	}
 
 	~EventManager() override;
+	
+	//! The global event manager as an EventManager, so the overloads this
+	//! class adds can be called on it. Returns nullptr if there is no
+	//! global manager or it is not an EventManager.
+	static EventManager* get() { return dynamic_cast<EventManager*>( EventManagerBase::get() ); }
 
-	bool addListener( EventListenerDelegate eventDelegate, EventType type ) override;
+	ListenerHandle addListener( EventListenerDelegate eventDelegate, EventType type, int32_t priority = 0 ) override;
 	bool removeListener( EventListenerDelegate eventDelegate, EventType type ) override;
+	//! Removes a listener of any kind.
+	bool removeListener( ListenerHandle handle ) override;
+	
+	//! Registers a listener that borrows each event instead of sharing
+	//! ownership of it. Borrowing and owning listeners are ordered together.
+	ListenerHandle addListener( BorrowedEventListenerDelegate eventDelegate, EventType type, int32_t priority = 0 );
+	bool removeListener( BorrowedEventListenerDelegate eventDelegate, EventType type );
+	//! Registers an EventDelegate, e.g. a lambda, which borrows each event.
+	//!
+	//!		eventManager->addListener( [this]( const EventData &event ) { ... }, MyEvent::TYPE );
+	ListenerHandle addListener( EventDelegate eventDelegate, EventType type, int32_t priority = 0 );
+	bool removeListener( EventDelegate eventDelegate, EventType type );
+	//! Both delegate types above take a free function, so these pick one.
+	template<typename Function>
+	IfFreeFunction<Function, ListenerHandle> addListener( Function function, EventType type, int32_t priority = 0 ) { return addListener( BorrowedEventListenerDelegate( function ), type, priority ); }
+	template<typename Function>
+	IfFreeFunction<Function, bool> removeListener( Function function, EventType type ) { return removeListener( BorrowedEventListenerDelegate( function ), type ); }
+	
+	//! Registers \a method of \a object for events of type T::TYPE, which it
+	//! receives as a const T& without casting. The manager downcasts on the
+	//! strength of the matched type id alone, so every event of that type
+	//! must be a T; debug builds assert it. Like borrowing listeners, typed
+	//! listeners don't share ownership of the event.
+	//!
+	//!		eventManager->addListener( this, &Circle::onMousePosition );
+	template<typename T, typename C>
+	ListenerHandle addListener( C *object, void (C::*method)( const T& ), int32_t priority = 0 )
+	{
+		return addListener( fastdelegate::MakeDelegate( object, method ), T::TYPE, priority );
+	}
+	template<typename T, typename C>
+	bool removeListener( C *object, void (C::*method)( const T& ) )
+	{
+		return removeListener( fastdelegate::MakeDelegate( object, method ), T::TYPE );
+	}
+	//! As above, for events of \a type.
+	template<typename T>
+	ListenerHandle addListener( fastdelegate::FastDelegate1<const T&, void> eventDelegate, EventType type, int32_t priority = 0 )
+	{
+		return insertListener( Listener::makeTyped( eventDelegate ), type, priority );
+	}
+	template<typename T>
+	bool removeListener( fastdelegate::FastDelegate1<const T&, void> eventDelegate, EventType type )
+	{
+		return removeListener( mEventListeners.find( type, DelegateKey( eventDelegate ) ) );
+	}
+	
+	//! Registers a listener that update() calls once with every queued event
+	//! of \a type it dispatched, after the regular listeners have seen them
+	//! all. Events are in queue order; with stopOnHandled, handled events are
+	//! left out. An event fired with triggerEvent arrives as a batch of one.
+	ListenerHandle addBatchListener( EventBatchListenerDelegate eventDelegate, EventType type, int32_t priority = 0 );
+	bool removeBatchListener( EventBatchListenerDelegate eventDelegate, EventType type );
+	
+	//! Registers a listener for InlineEvent payloads of type T under \a type.
+	//! It is ordered together with the type's other listeners, but only
+	//! inline events reach it and only EventData events reach them.
+	template<typename T>
+	ListenerHandle addInlineListener( fastdelegate::FastDelegate1<const T&, void> eventDelegate, EventType type, int32_t priority = 0 )
+	{
+		return insertListener( Listener::makeInline( eventDelegate ), type, priority );
+	}
+	template<typename T>
+	bool removeInlineListener( fastdelegate::FastDelegate1<const T&, void> eventDelegate, EventType type )
+	{
+		return removeListener( mEventListeners.find( type, DelegateKey( eventDelegate ) ) );
+	}
 	
 	bool triggerEvent( EventDataRef event ) override;
+	bool triggerEvent( const InlineEvent &event );
+	//! In QueueMode::CONCURRENT and PER_THREAD this is thread safe and always
+	//! returns true; events without listeners are dropped when update()
+	//! collects them.
 	bool queueEvent( EventDataRef event ) override;
+	//! Copies \a event into the queue. Must be called on the thread that
+	//! calls update() whatever the QueueMode, and in QueueMode::CONCURRENT and
+	//! PER_THREAD the event goes ahead of anything still waiting in producer
+	//! buffers.
+	bool queueEvent( const InlineEvent &event );
+	//! Takes time proportional to the number of events aborted, not to the
+	//! length of the queue.
 	bool abortEvent( EventType type, bool allOfType ) override;
 	
-	bool addThreadedListener( EventListenerDelegate eventDelegate, EventType type ) override;
+	//! Bounds how many events of \a type can pile up between updates: an event
+	//! queued while another of the same type and \a key is still waiting is
+	//! handled according to \a policy instead of being appended. Without a
+	//! key function all events of the type share one key. Only events that
+	//! haven't been picked up by update() yet are coalesced.
+	void setCoalescing( EventType type, CoalescePolicy policy, CoalesceKeyFn key = CoalesceKeyFn() );
+	//! As above, combining the two events with \a merge.
+	void setCoalescing( EventType type, CoalesceMergeFn merge, CoalesceKeyFn key = CoalesceKeyFn() );
+	
+	ListenerHandle addThreadedListener( EventListenerDelegate eventDelegate, EventType type, int32_t priority = 0 ) override;
 	bool removeThreadedListener( EventListenerDelegate eventDelegate, EventType type ) override;
+	ListenerHandle addThreadedListener( BorrowedEventListenerDelegate eventDelegate, EventType type, int32_t priority = 0 );
+	bool removeThreadedListener( BorrowedEventListenerDelegate eventDelegate, EventType type );
+	ListenerHandle addThreadedListener( EventDelegate eventDelegate, EventType type, int32_t priority = 0 );
+	bool removeThreadedListener( EventDelegate eventDelegate, EventType type );
+	template<typename Function>
+	IfFreeFunction<Function, ListenerHandle> addThreadedListener( Function function, EventType type, int32_t priority = 0 ) { return addThreadedListener( BorrowedEventListenerDelegate( function ), type, priority ); }
+	template<typename Function>
+	IfFreeFunction<Function, bool> removeThreadedListener( Function function, EventType type ) { return removeThreadedListener( BorrowedEventListenerDelegate( function ), type ); }
+	template<typename T>
+	ListenerHandle addThreadedListener( fastdelegate::FastDelegate1<const T&, void> eventDelegate, EventType type, int32_t priority = 0 )
+	{
+		return insertThreadedListener( Listener::makeTyped( eventDelegate ), type, priority );
+	}
+	template<typename T>
+	bool removeThreadedListener( fastdelegate::FastDelegate1<const T&, void> eventDelegate, EventType type )
+	{
+		return removeThreadedListener( DelegateKey( eventDelegate ), type );
+	}
+	bool removeThreadedListener( ListenerHandle handle ) override;
 	void removeAllThreadedListeners() override;
 	bool triggerThreadedEvent( EventDataRef event ) override;
 	
+	//! Processes the events queued before the call until they are exhausted or
+	//! \a maxMillis of wall-clock time have passed, measured on a monotonic
+	//! clock. Events that didn't fit stay queued, ahead of anything queued since.
 	bool update( uint64_t maxMillis = kINFINITE ) override;
+	
+	//! Creates an event in the frame arena: memory is bump-allocated and
+	//! reclaimed in one go rather than freed event by event. Events created
+	//! before an update() come from the arena that is rewound at the start
+	//! of the update() after, provided none of them is still referenced by
+	//! then; otherwise the arena keeps growing until they are all gone. Use
+	//! EventData::copy() for events that must be kept longer. Must be called
+	//! on the thread that calls update(), and the events must not outlive the
+	//! manager.
+	template<typename T, typename... Args>
+	EventPtr<T> createFrameEvent( Args&&... args )
+	{
+		return prepareEvent( createArenaEvent<T>( mArenas[mActiveArena].get(), std::forward<Args>( args )... ) );
+	}
+	
+	//! Creates an event through EventPool<T>, set up for this manager's
+	//! Format::singleThreaded() setting.
+	template<typename T, typename... Args>
+	EventPtr<T> createEvent( Args&&... args )
+	{
+		return prepareEvent( EventPool<T>::create( std::forward<Args>( args )... ) );
+	}
+	
+	//! Describes how the most recent update() went.
+	struct UpdateStats {
+		UpdateStats() : mElapsedMillis( 0 ), mNumProcessed( 0 ), mNumRemaining( 0 ), mTimedOut( false ) {}
+		//! Wall-clock time spent in update(), including listeners.
+		double	mElapsedMillis;
+		size_t	mNumProcessed;
+		//! Events waiting for the next update(), leftovers included.
+		size_t	mNumRemaining;
+		//! Whether processing stopped because maxMillis ran out.
+		bool	mTimedOut;
+	};
+	const UpdateStats& getLastUpdateStats() const { return mLastUpdateStats; }
 
 private:
-	explicit EventManager( std::string name, bool setAsGlobal );
+	EventManager( std::string name, bool setAsGlobal, const Format &format );
 	
+	//! Appends \a event to the active queue if anyone listens for it.
+	bool enqueue( EventDataRef event );
+	//! Removes \a sequence, about to be dispatched, from \a listeners'
+	//! queued events, along with any dropped ones ahead of it.
+	static void popQueued( EventListenerList &listeners, EventQueue::Sequence sequence );
+	//! Moves everything other threads queued into the active queue.
+	void drainProducerQueues();
+	//! Returns the calling thread's buffer, registering one on first use.
+	ProducerQueue& getProducerQueue();
+	ListenerHandle insertListener( Listener listener, EventType type, int32_t priority );
+	ListenerHandle insertThreadedListener( Listener listener, EventType type, int32_t priority );
+	bool removeThreadedListener( const DelegateKey &key, EventType type );
+	//! Tidies up the lists listeners changed while events were firing.
 	void consumeAfterListeners();
+	//! Hands every batch collected by update() to its batch listeners.
+	void dispatchBatches();
+	static void dispatchBatch( const EventListenerList &listeners, const EventSpan &events );
+	//! Hands \a event to the inline listeners in \a listeners. Returns
+	//! whether there were any.
+	static bool dispatchInline( const EventListenerList &listeners, const InlineEvent &event );
+	//! Publishes a new threaded snapshot with the array for \a listeners'
+	//! type rebuilt from it. Requires mThreadedEventListenerMutex.
+	void publishThreadedListeners( const EventListenerList &listeners );
+	//! Replaces the threaded snapshot. Requires mThreadedEventListenerMutex.
+	void publishThreadedListeners( std::shared_ptr<const ThreadedListenerSnapshot> snapshot );
+	//! Takes the calling thread's cached snapshot if it is current, otherwise
+	//! fetches the latest one. Sets \a version to the snapshot's version.
+	std::shared_ptr<const ThreadedListenerSnapshot> acquireThreadedListeners( uint64_t &version ) const;
+	//! Hands a snapshot back to the calling thread's cache once dispatch is done.
+	void releaseThreadedListeners( std::shared_ptr<const ThreadedListenerSnapshot> snapshot, uint64_t version ) const;
+	static ThreadedListenerCache& getThreadedListenerCache();
+	//! Applies Format::singleThreaded() to a freshly created event.
+	template<typename T>
+	EventPtr<T> prepareEvent( EventPtr<T> event ) const
+	{
+#if defined( CINDER_EVENTMANAGER_INTRUSIVE_REFS )
+		// Still the only reference, so the counter can change modes.
+		event->setRefCountAtomic( ! mSingleThreaded );
+#endif
+		return event;
+	}
+	
+	//! Serializes writers, and readers whose cached snapshot is out of date.
+	mutable std::mutex								mThreadedEventListenerMutex;
+	ListenerTable									mThreadedEventListeners;
+	//! Guarded by mThreadedEventListenerMutex.
+	std::shared_ptr<const ThreadedListenerSnapshot>	mThreadedListenerSnapshot;
+	//! Bumped after every change to mThreadedListenerSnapshot.
+	std::atomic<uint64_t>							mThreadedListenerVersion;
+	
+	ListenerTable						mEventListeners;
+	//! Events waiting for update(). Aborted events leave a null entry behind.
+	EventQueue							mQueue;
+	//! Empty entries in mQueue.
+	size_t								mNumAbortedEvents;
+	//! Lists with a non-empty mBatch.
+	std::vector<EventListenerList*>		mBatchedLists;
+	//! Frame arenas, alternating each update(). Heap allocated so arenas
+	//! still referenced when the manager dies can be leaked instead.
+	std::unique_ptr<EventArena>			mArenas[2];
+	uint32_t							mActiveArena;
+	//! Sequence in mQueue of the event each CoalesceKey maps to.
+	std::unordered_map<CoalesceKey, EventQueue::Sequence, CoalesceKeyHash>	mCoalescedEvents;
+	const QueueMode						mQueueMode;
+	const MergeOrder					mMergeOrder;
+	const bool							mStopOnHandled;
+	const bool							mSingleThreaded;
+	ConcurrentEventQueue				mConcurrentQueue;
+	
+	//! Identifies this manager in per-thread caches; never reused.
+	const uint64_t								mId;
+	std::mutex									mProducerQueuesMutex;
+	std::vector<std::shared_ptr<ProducerQueue>>	mProducerQueues;
+	std::vector<EventDataRef>					mMergedEvents;
 	
-	std::mutex							mThreadedEventListenerMutex;
-	EventListenerMap					mThreadedEventListeners;
+	struct Coalescing {
+		CoalescePolicy	mPolicy;
+		CoalesceMergeFn	mMerge;
+		CoalesceKeyFn	mKey;
+	};
+	void setCoalescing( EventType type, std::unique_ptr<Coalescing> coalescing );
 	
-	EventListenerMap					mEventListeners;
-	std::array<EventQueue, NUM_QUEUES>  mQueues;
-	uint32_t							mActiveQueue;
+	bool							mFiringEvent;
 	
-	using ListenerQueue = std::vector<std::pair<EventType, EventListenerDelegate>>;
-	ListenerQueue	mAddAfter, mRemoveAfter;
-	bool			mFiringEvent;
+	//! Upper bound on events processed between two reads of the clock when
+	//! update() has a time limit.
+	static const size_t				kMaxClockCheckInterval = 256;
+	UpdateStats						mLastUpdateStats;
 };
 
 /* The classes below are exported */
@@ -49,6 +49,45 @@
 	
 using EventType				= uint64_t;
 using EventListenerDelegate = fastdelegate::FastDelegate1<EventDataRef, void>;
+//! Listener that only borrows the event for the duration of the call. Unlike
+//! EventListenerDelegate it costs no reference count traffic per call; take
+//! EventListenerDelegate instead when the event has to be kept.
+using BorrowedEventListenerDelegate = fastdelegate::FastDelegate1<const EventData&, void>;
+
+//! Identifies a single listener registration. A handle is a slot index plus
+//! the generation the slot had when the listener was added, so a handle whose
+//! listener is already gone is rejected instead of removing a newer one. It
+//! also records the listener table that issued it, so a handle passed to the
+//! wrong remove function or event manager is rejected too.
+//!
+//! addListener and addThreadedListener used to return bool and now return a
+//! handle. The conversion to bool is explicit, so testing the result in an
+//! if, !, && or || still compiles, but `bool added = addListener( ... );`,
+//! returning it from a function that returns bool, and overrides of the old
+//! bool signatures do not; use isValid() or static_cast<bool> there.
+class ListenerHandle {
+public:
+	ListenerHandle() : mIndex( kInvalidIndex ), mGeneration( 0 ), mTable( 0 ) {}
+	ListenerHandle( uint32_t index, uint32_t generation, uint32_t table ) : mIndex( index ), mGeneration( generation ), mTable( table ) {}
+	
+	uint32_t getIndex() const { return mIndex; }
+	uint32_t getGeneration() const { return mGeneration; }
+	//! Id of the issuing table, unique per process. Zero for invalid handles.
+	uint32_t getTable() const { return mTable; }
+	
+	bool isValid() const { return mIndex != kInvalidIndex; }
+	explicit operator bool() const { return isValid(); }
+	
+	bool operator==( const ListenerHandle &other ) const { return mIndex == other.mIndex && mGeneration == other.mGeneration && mTable == other.mTable; }
+	bool operator!=( const ListenerHandle &other ) const { return ! ( *this == other ); }
+	
+private:
+	static const uint32_t kInvalidIndex = 0xffffffff;
+	
+	uint32_t mIndex;
+	uint32_t mGeneration;
+	uint32_t mTable;
+};
 
 class EventManagerBase {
 public:
@@ -58,12 +97,19 @@ public:
 	virtual ~EventManagerBase();
 	
 	//! Registers a delegate function that will get called when the event type is
-	//! triggered. Returns true if successful, false if not.
-	virtual bool addListener( EventListenerDelegate eventDelegate, EventType type ) = 0;
+	//! triggered. Listeners with a higher \a priority are called first, those
+	//! with equal priority in registration order. Returns a handle that can be
+	//! passed to removeListener, or an invalid handle if the delegate was
+	//! already registered for this type.
+	virtual ListenerHandle addListener( EventListenerDelegate eventDelegate, EventType type, int32_t priority = 0 ) = 0;
 	
 	//! Removes a delegate / event type pairing from the internal tables.
 	//! Returns false if the pairing was not found.
 	virtual bool removeListener( EventListenerDelegate eventDelegate, EventType type ) = 0;
+	//! Removes the listener registered under \a handle in constant time. Safe
+	//! to call while an event is being fired. Returns false if the handle is
+	//! invalid or its listener was already removed.
+	virtual bool removeListener( ListenerHandle handle ) = 0;
 	
 	//! Fires off event NOW. This bypasses the queue entirely and immediately
 	//! calls all delegate functions registered for the event.
@@ -100,13 +146,19 @@ public:
 	
 	//! Registers a delegate function that will get called when the event type is
 	//! triggered. NOTE: This listener can be called from any thread. Appropriate
-	//! locks in the listener should be considered. Returns true if successful,
-	//! false if not. This function is Thread Safe
-	virtual bool addThreadedListener( EventListenerDelegate eventDelegate, EventType type ) = 0;
+	//! locks in the listener should be considered. Returns a handle for
+	//! removeThreadedListener, or an invalid handle if the delegate was already
+	//! registered. \a priority orders listeners as in addListener. This
+	//! function is Thread Safe
+	virtual ListenerHandle addThreadedListener( EventListenerDelegate eventDelegate, EventType type, int32_t priority = 0 ) = 0;
 	//! Removes a delegate / event type pairing from the internal tables. This
-	//! function removes in a Thread Safe manner. Returns false if the pairing
-	//! was not found.
+	//! function removes in a Thread Safe manner. A dispatch already running on
+	//! another thread may still call the delegate once after this returns.
+	//! Returns false if the pairing was not found.
 	virtual bool removeThreadedListener( EventListenerDelegate eventDelegate, EventType type ) = 0;
+	//! Removes the threaded listener registered under \a handle in constant
+	//! time. Thread Safe. Returns false if the handle is stale.
+	virtual bool removeThreadedListener( ListenerHandle handle ) = 0;
 	//! Fires off event NOW. NOTE: This function could be called from any thread.
 	//! This bypasses the queue entirely and immediately calls all delegate functions
 	//! registered to listen for this event.
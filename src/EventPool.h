@@ -0,0 +1,223 @@
+//
+//  EventPool.h
+//  Cinder-EventManager
+//
+//  Recycling allocation for EventData subclasses.
+//
+
+#pragma once
+#pragma warning( push )
+#pragma warning( disable : 4068 )
+/* The classes below are exported */
+#pragma GCC visibility push(default)
+#pragma warning( pop )
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+#include "BaseEventData.h"
+
+//! Lets EventPool construct events whose constructors are private, the way
+//! create() functions usually keep them. Befriend it to use the pool.
+struct EventPoolAccess {
+	template<typename T, typename... Args>
+	static void construct( T *p, Args&&... args ) { ::new( static_cast<void*>( p ) ) T( std::forward<Args>( args )... ); }
+};
+
+//! Allocator whose single-object allocations come from a free list per
+//! allocated type, so a shared_ptr's combined control block and event are
+//! reused once the last reference drops. Each thread keeps a private cache
+//! of free blocks; caches that grow too large hand a batch of blocks to a
+//! shared list, and empty caches take one back, so events created on one
+//! thread and released on another still recycle without a lock per event.
+//! Blocks are never given back to the system.
+template<typename T>
+class EventPoolAllocator {
+public:
+	using value_type = T;
+
+	EventPoolAllocator() = default;
+	template<typename U>
+	EventPoolAllocator( const EventPoolAllocator<U>& ) {}
+
+	T* allocate( size_t n )
+	{
+		if( n != 1 )
+			return static_cast<T*>( ::operator new( n * sizeof( T ) ) );
+		return static_cast<T*>( FreeList::allocate() );
+	}
+	void deallocate( T *p, size_t n )
+	{
+		if( n != 1 )
+			::operator delete( p );
+		else
+			FreeList::deallocate( p );
+	}
+
+	template<typename U, typename... Args>
+	void construct( U *p, Args&&... args ) { EventPoolAccess::construct( p, std::forward<Args>( args )... ); }
+	template<typename U>
+	void destroy( U *p ) { p->~U(); }
+
+	template<typename U>
+	bool operator==( const EventPoolAllocator<U>& ) const { return true; }
+	template<typename U>
+	bool operator!=( const EventPoolAllocator<U>& ) const { return false; }
+
+private:
+	class FreeList {
+	public:
+		static void* allocate()
+		{
+			auto &cache = getCache();
+			if( ! cache.mHead )
+				cache.refill();
+			if( ! cache.mHead )
+				return ::operator new( sizeof( Block ) );
+
+			auto node = cache.mHead;
+			cache.mHead = node->mNext;
+			--cache.mSize;
+			return node;
+		}
+
+		static void deallocate( void *p )
+		{
+			auto &cache = getCache();
+			auto node = static_cast<Node*>( p );
+			node->mNext = cache.mHead;
+			cache.mHead = node;
+			if( ++cache.mSize >= 2 * kBatchSize )
+				cache.spill( kBatchSize );
+		}
+
+	private:
+		union Block {
+			void	*mNext;
+			alignas( T ) unsigned char mStorage[sizeof( T )];
+		};
+		struct Node {
+			Node	*mNext;
+		};
+		static_assert( alignof( T ) <= alignof( std::max_align_t ), "over-aligned events are not supported" );
+
+		static const size_t kBatchSize = 64;
+
+		struct Batch {
+			Node	*mHead;
+			size_t	mSize;
+		};
+
+		struct Shared {
+			~Shared()
+			{
+				for( auto &batch : mBatches )
+					release( batch.mHead );
+			}
+			std::mutex			mMutex;
+			std::vector<Batch>	mBatches;
+		};
+
+		struct Cache {
+			Cache() : mHead( nullptr ), mSize( 0 ) {}
+			~Cache() { spill( mSize ); }
+
+			//! Takes a batch from the shared list, if there is one.
+			void refill()
+			{
+				auto &shared = getShared();
+				std::lock_guard<std::mutex> lock( shared.mMutex );
+				if( shared.mBatches.empty() )
+					return;
+				mHead = shared.mBatches.back().mHead;
+				mSize = shared.mBatches.back().mSize;
+				shared.mBatches.pop_back();
+			}
+
+			//! Hands the first \a count blocks to the shared list.
+			void spill( size_t count )
+			{
+				if( count == 0 )
+					return;
+				Batch batch = { mHead, count };
+				auto last = mHead;
+				for( size_t i = 1; i < count; ++i )
+					last = last->mNext;
+				mHead = last->mNext;
+				last->mNext = nullptr;
+				mSize -= count;
+
+				auto &shared = getShared();
+				std::lock_guard<std::mutex> lock( shared.mMutex );
+				shared.mBatches.push_back( batch );
+			}
+
+			Node	*mHead;
+			size_t	mSize;
+		};
+
+		static void release( Node *node )
+		{
+			while( node ) {
+				auto next = node->mNext;
+				::operator delete( node );
+				node = next;
+			}
+		}
+
+		static Shared& getShared()
+		{
+			static Shared sShared;
+			return sShared;
+		}
+		static Cache& getCache()
+		{
+			// Make sure the shared list outlives this thread's cache.
+			getShared();
+			static thread_local Cache sCache;
+			return sCache;
+		}
+	};
+};
+
+//! Creates events of type T through EventPoolAllocator. After warm-up,
+//! creating and releasing events allocates nothing from the global heap.
+//!
+//!		static MyEventRef create( int value ) { return EventPool<MyEvent>::create( value ); }
+template<typename T>
+class EventPool {
+public:
+	template<typename... Args>
+	static EventPtr<T> create( Args&&... args )
+	{
+#if defined( CINDER_EVENTMANAGER_INTRUSIVE_REFS )
+		// No control block: the event itself is the pooled block.
+		EventPoolAllocator<T> allocator;
+		auto p = allocator.allocate( 1 );
+		allocator.construct( p, std::forward<Args>( args )... );
+		p->setDestroyFn( &EventPool::destroy );
+		return EventPtr<T>( p );
+#else
+		return std::allocate_shared<T>( EventPoolAllocator<T>(), std::forward<Args>( args )... );
+#endif
+	}
+	
+private:
+#if defined( CINDER_EVENTMANAGER_INTRUSIVE_REFS )
+	static void destroy( EventData *event )
+	{
+		EventPoolAllocator<T> allocator;
+		auto p = static_cast<T*>( event );
+		allocator.destroy( p );
+		allocator.deallocate( p, 1 );
+	}
+#endif
+};
+
+#pragma warning( push )
+#pragma warning( disable : 4068 )
+#pragma GCC visibility pop
+#pragma warning( pop )
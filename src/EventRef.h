@@ -0,0 +1,90 @@
+//
+//  EventRef.h
+//  Cinder-EventManager
+//
+//  Intrusively reference counted event handle.
+//
+
+#pragma once
+#pragma warning( push )
+#pragma warning( disable : 4068 )
+/* The classes below are exported */
+#pragma GCC visibility push(default)
+#pragma warning( pop )
+
+#include <cstddef>
+#include <functional>
+#include <type_traits>
+#include <utility>
+
+//! Handle to an object that counts its own references, such as EventData
+//! built with CINDER_EVENTMANAGER_INTRUSIVE_REFS. Unlike std::shared_ptr
+//! there is no control block and copying a handle touches only the object's
+//! counter, which is a plain integer for events that never cross threads.
+//! The interface follows std::shared_ptr closely enough for EventDataRef to
+//! be either.
+template<typename T>
+class EventRef {
+public:
+	EventRef() : mPtr( nullptr ) {}
+	EventRef( std::nullptr_t ) : mPtr( nullptr ) {}
+	//! Takes a reference to \a object.
+	explicit EventRef( T *object ) : mPtr( object ) { if( mPtr ) mPtr->addRef(); }
+	EventRef( const EventRef &other ) : mPtr( other.mPtr ) { if( mPtr ) mPtr->addRef(); }
+	EventRef( EventRef &&other ) noexcept : mPtr( other.mPtr ) { other.mPtr = nullptr; }
+	template<typename U, typename = typename std::enable_if<std::is_convertible<U*, T*>::value>::type>
+	EventRef( const EventRef<U> &other ) : mPtr( other.get() ) { if( mPtr ) mPtr->addRef(); }
+	template<typename U, typename = typename std::enable_if<std::is_convertible<U*, T*>::value>::type>
+	EventRef( EventRef<U> &&other ) noexcept : mPtr( other.detach() ) {}
+	~EventRef() { if( mPtr ) mPtr->release(); }
+
+	EventRef& operator=( EventRef other ) noexcept { swap( other ); return *this; }
+
+	T* get() const { return mPtr; }
+	T& operator*() const { return *mPtr; }
+	T* operator->() const { return mPtr; }
+	explicit operator bool() const { return mPtr != nullptr; }
+
+	void reset() { EventRef().swap( *this ); }
+	void reset( T *object ) { EventRef( object ).swap( *this ); }
+	void swap( EventRef &other ) noexcept { std::swap( mPtr, other.mPtr ); }
+	long use_count() const { return mPtr ? static_cast<long>( mPtr->getRefCount() ) : 0; }
+
+	//! Gives up the reference without releasing it.
+	T* detach() { auto ptr = mPtr; mPtr = nullptr; return ptr; }
+
+private:
+	T	*mPtr;
+};
+
+template<typename T, typename U>
+bool operator==( const EventRef<T> &a, const EventRef<U> &b ) { return a.get() == b.get(); }
+template<typename T, typename U>
+bool operator!=( const EventRef<T> &a, const EventRef<U> &b ) { return a.get() != b.get(); }
+template<typename T>
+bool operator==( const EventRef<T> &a, std::nullptr_t ) { return ! a; }
+template<typename T>
+bool operator!=( const EventRef<T> &a, std::nullptr_t ) { return !! a; }
+template<typename T>
+bool operator==( std::nullptr_t, const EventRef<T> &a ) { return ! a; }
+template<typename T>
+bool operator!=( std::nullptr_t, const EventRef<T> &a ) { return !! a; }
+
+//! Counterparts of the std::shared_ptr casts. Call them unqualified and the
+//! same code compiles whichever EventDataRef is.
+template<typename T, typename U>
+EventRef<T> static_pointer_cast( const EventRef<U> &ref ) { return EventRef<T>( static_cast<T*>( ref.get() ) ); }
+template<typename T, typename U>
+EventRef<T> dynamic_pointer_cast( const EventRef<U> &ref ) { return EventRef<T>( dynamic_cast<T*>( ref.get() ) ); }
+
+namespace std {
+	template<typename T>
+	struct hash<EventRef<T>> {
+		size_t operator()( const EventRef<T> &ref ) const { return hash<T*>()( ref.get() ); }
+	};
+}
+
+#pragma warning( push )
+#pragma warning( disable : 4068 )
+#pragma GCC visibility pop
+#pragma warning( pop )
@@ -0,0 +1,96 @@
+//
+//  EventRingBuffer.h
+//  Cinder-EventManager
+//
+//  Growable ring buffer used for queued events.
+//
+
+#pragma once
+#pragma warning( push )
+#pragma warning( disable : 4068 )
+/* The classes below are exported */
+#pragma GCC visibility push(default)
+#pragma warning( pop )
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+//! FIFO over a power-of-two array. Every pushed item gets a sequence number
+//! that keeps identifying it until it is popped, even across growth, since an
+//! item's slot is simply its sequence masked by the capacity. Popping only
+//! advances the head, so items left over when processing stops stay where
+//! they are, and the array is reused from one update to the next instead of
+//! being reallocated.
+template<typename T>
+class RingBuffer {
+public:
+	using Sequence = uint64_t;
+
+	RingBuffer() : mHead( 0 ), mTail( 0 ), mMask( 0 ) {}
+
+	bool empty() const { return mHead == mTail; }
+	size_t size() const { return static_cast<size_t>( mTail - mHead ); }
+	size_t capacity() const { return mItems.size(); }
+
+	//! Sequence of the front item.
+	Sequence beginSequence() const { return mHead; }
+	//! Sequence the next pushed item will get.
+	Sequence endSequence() const { return mTail; }
+	bool contains( Sequence sequence ) const { return sequence >= mHead && sequence < mTail; }
+
+	//! Appends \a item, doubling the capacity if the buffer is full, and
+	//! returns its sequence.
+	Sequence push_back( T item )
+	{
+		if( size() == mItems.size() )
+			grow();
+		mItems[mTail & mMask] = std::move( item );
+		return mTail++;
+	}
+
+	//! Removes the front item and hands it over. The buffer must not be empty.
+	T pop_front()
+	{
+		auto &item = mItems[mHead++ & mMask];
+		auto result = std::move( item );
+		item = T();
+		return result;
+	}
+
+	T& front() { return mItems[mHead & mMask]; }
+	const T& front() const { return mItems[mHead & mMask]; }
+
+	//! Accesses a queued item by sequence, which must be contained.
+	T& operator[]( Sequence sequence ) { return mItems[sequence & mMask]; }
+	const T& operator[]( Sequence sequence ) const { return mItems[sequence & mMask]; }
+
+	//! Releases every queued item but keeps the capacity.
+	void clear()
+	{
+		while( mHead != mTail )
+			mItems[mHead++ & mMask] = T();
+	}
+
+private:
+	void grow()
+	{
+		const auto capacity = mItems.empty() ? size_t( 16 ) : mItems.size() * 2;
+		std::vector<T> items( capacity );
+		for( auto sequence = mHead; sequence != mTail; ++sequence )
+			items[sequence & ( capacity - 1 )] = std::move( mItems[sequence & mMask] );
+		mItems.swap( items );
+		mMask = capacity - 1;
+	}
+
+	std::vector<T>				mItems;
+	Sequence					mHead;
+	Sequence					mTail;
+	size_t						mMask;
+};
+
+#pragma warning( push )
+#pragma warning( disable : 4068 )
+#pragma GCC visibility pop
+#pragma warning( pop )
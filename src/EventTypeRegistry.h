@@ -0,0 +1,91 @@
+//
+//  EventTypeRegistry.h
+//  Cinder-EventManager
+//
+//  Assigns dense, process-wide indices to 64-bit EventTypes.
+//
+
+#pragma once
+#pragma warning( push )
+#pragma warning( disable : 4068 )
+/* The classes below are exported */
+#pragma GCC visibility push(default)
+#pragma warning( pop )
+
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+using EventType			= uint64_t;
+using EventTypeIndex	= uint32_t;
+
+const EventTypeIndex kInvalidEventTypeIndex = 0xffffffff;
+
+//! Hands out small consecutive indices for event types so dispatch tables can
+//! be plain arrays. Registration is opt-in: an event class registers its TYPE
+//! once, usually while initializing statics, and passes the index to the
+//! EventData constructor along with the type. The 64-bit EventType stays the identity used for
+//! serialization and across processes; indices are only stable within one run.
+class EventTypeRegistry {
+public:
+	//! Returns the index of \a type, assigning the next free one the first time
+	//! the type is seen. Thread safe.
+	static EventTypeIndex registerType( EventType type )
+	{
+		auto &registry = get();
+		std::lock_guard<std::mutex> lock( registry.mMutex );
+
+		const auto inserted = registry.mIndices.emplace( type, static_cast<EventTypeIndex>( registry.mTypes.size() ) );
+		if( inserted.second )
+			registry.mTypes.push_back( type );
+		return inserted.first->second;
+	}
+
+	//! Returns the index of \a type, or kInvalidEventTypeIndex if it was never
+	//! registered. Thread safe.
+	static EventTypeIndex find( EventType type )
+	{
+		auto &registry = get();
+		std::lock_guard<std::mutex> lock( registry.mMutex );
+
+		const auto found = registry.mIndices.find( type );
+		return found != registry.mIndices.end() ? found->second : kInvalidEventTypeIndex;
+	}
+
+	//! Returns the EventType registered under \a index. Thread safe.
+	static EventType getType( EventTypeIndex index )
+	{
+		auto &registry = get();
+		std::lock_guard<std::mutex> lock( registry.mMutex );
+
+		return index < registry.mTypes.size() ? registry.mTypes[index] : 0;
+	}
+
+	//! Returns the number of registered types, which bounds every index.
+	static size_t size()
+	{
+		auto &registry = get();
+		std::lock_guard<std::mutex> lock( registry.mMutex );
+
+		return registry.mTypes.size();
+	}
+
+private:
+	EventTypeRegistry() = default;
+
+	static EventTypeRegistry& get()
+	{
+		static EventTypeRegistry sRegistry;
+		return sRegistry;
+	}
+
+	std::mutex										mMutex;
+	std::unordered_map<EventType, EventTypeIndex>	mIndices;
+	std::vector<EventType>							mTypes;
+};
+
+#pragma warning( push )
+#pragma warning( disable : 4068 )
+#pragma GCC visibility pop
+#pragma warning( pop )
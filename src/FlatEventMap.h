@@ -0,0 +1,144 @@
+//
+//  FlatEventMap.h
+//  Cinder-EventManager
+//
+//  Open-addressing hash table keyed on the 64-bit EventType.
+//
+
+#pragma once
+#pragma warning( push )
+#pragma warning( disable : 4068 )
+/* The classes below are exported */
+#pragma GCC visibility push(default)
+#pragma warning( pop )
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+using EventType = uint64_t;
+
+//! Maps an EventType to a value using linear probing over a power-of-two
+//! slot array. Values live in a deque so references handed out stay valid
+//! while new types are inserted, which lets dispatch hold on to a value while
+//! a listener registers a previously unseen type. Entries are never erased
+//! individually; clear() drops everything at once.
+template<typename T>
+class FlatEventMap {
+public:
+	FlatEventMap() : mMask( 0 ) {}
+	//! Copies rebuild the slot array, since slots point into mEntries.
+	FlatEventMap( const FlatEventMap &other ) : mEntries( other.mEntries ), mMask( 0 )
+	{
+		if( ! other.mSlots.empty() )
+			rehash( other.mSlots.size() );
+	}
+	FlatEventMap& operator=( const FlatEventMap &other )
+	{
+		if( this != &other ) {
+			mEntries = other.mEntries;
+			mSlots.clear();
+			mMask = 0;
+			if( ! other.mSlots.empty() )
+				rehash( other.mSlots.size() );
+		}
+		return *this;
+	}
+
+	//! Returns the value stored for \a type, or nullptr if there is none.
+	T* find( EventType type )
+	{
+		if( mSlots.empty() )
+			return nullptr;
+
+		auto index = hash( type ) & mMask;
+		while( true ) {
+			const auto &slot = mSlots[index];
+			if( ! slot.mValue )
+				return nullptr;
+			if( slot.mKey == type )
+				return slot.mValue;
+			index = ( index + 1 ) & mMask;
+		}
+	}
+	const T* find( EventType type ) const { return const_cast<FlatEventMap*>( this )->find( type ); }
+
+	//! Returns the value stored for \a type, default constructing it if needed.
+	T& operator[]( EventType type )
+	{
+		if( auto found = find( type ) )
+			return *found;
+		return insert( type );
+	}
+
+	size_t size() const { return mEntries.size(); }
+	bool empty() const { return mEntries.empty(); }
+
+	void clear()
+	{
+		mSlots.clear();
+		mEntries.clear();
+		mMask = 0;
+	}
+
+	//! Iteration visits (type, value) pairs in insertion order.
+	using Entry = std::pair<EventType, T>;
+	typename std::deque<Entry>::iterator begin() { return mEntries.begin(); }
+	typename std::deque<Entry>::iterator end() { return mEntries.end(); }
+	typename std::deque<Entry>::const_iterator begin() const { return mEntries.begin(); }
+	typename std::deque<Entry>::const_iterator end() const { return mEntries.end(); }
+
+private:
+	struct Slot {
+		Slot() : mKey( 0 ), mValue( nullptr ) {}
+		EventType	mKey;
+		T			*mValue;
+	};
+
+	//! EventTypes are usually string hashes already, but nothing guarantees
+	//! their low bits are well distributed, so fold and scramble them.
+	static size_t hash( EventType type )
+	{
+		type ^= type >> 33;
+		type *= 0xff51afd7ed558ccdULL;
+		type ^= type >> 33;
+		return static_cast<size_t>( type );
+	}
+
+	T& insert( EventType type )
+	{
+		// Keep the load factor at or below one half so probe runs stay short.
+		if( ( mEntries.size() + 1 ) * 2 > mSlots.size() )
+			rehash( mSlots.empty() ? 16 : mSlots.size() * 2 );
+
+		mEntries.emplace_back( type, T() );
+		place( type, &mEntries.back().second );
+		return mEntries.back().second;
+	}
+
+	void place( EventType type, T *value )
+	{
+		auto index = hash( type ) & mMask;
+		while( mSlots[index].mValue )
+			index = ( index + 1 ) & mMask;
+		mSlots[index].mKey = type;
+		mSlots[index].mValue = value;
+	}
+
+	void rehash( size_t capacity )
+	{
+		mSlots.assign( capacity, Slot() );
+		mMask = capacity - 1;
+		for( auto &entry : mEntries )
+			place( entry.first, &entry.second );
+	}
+
+	std::vector<Slot>	mSlots;
+	std::deque<Entry>	mEntries;
+	size_t				mMask;
+};
+
+#pragma warning( push )
+#pragma warning( disable : 4068 )
+#pragma GCC visibility pop
+#pragma warning( pop )
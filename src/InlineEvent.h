@@ -0,0 +1,70 @@
+//
+//  InlineEvent.h
+//  Cinder-EventManager
+//
+//  Small value events queued without an EventData object.
+//
+
+#pragma once
+#pragma warning( push )
+#pragma warning( disable : 4068 )
+/* The classes below are exported */
+#pragma GCC visibility push(default)
+#pragma warning( pop )
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include "BaseEventData.h"
+
+//! Event that is just a type id and a trivially copyable payload of at most
+//! kMaxSize bytes, e.g. a position or an entity id. The payload is copied
+//! into the event manager's queue slot, so queueing one allocates nothing,
+//! and listeners registered with EventManager::addInlineListener() receive
+//! it as a const T& without a virtual call. Inline events share the type
+//! id space, queue order and abortEvent() with EventData events, but never
+//! reach EventData listeners, batch listeners or coalescing.
+class InlineEvent {
+public:
+	//! Sized so a queue slot holding an inline event fits a cache line.
+	static const size_t kMaxSize = 32;
+
+	InlineEvent() : mType( 0 ), mSize( 0 ) {}
+	template<typename T>
+	InlineEvent( EventType type, const T &payload ) : mType( type ), mSize( sizeof( T ) )
+	{
+		static_assert( std::is_trivially_copyable<T>::value, "inline event payloads must be trivially copyable" );
+		static_assert( sizeof( T ) <= kMaxSize, "inline event payload exceeds InlineEvent::kMaxSize" );
+		static_assert( alignof( T ) <= alignof( Storage ), "inline event payload is over-aligned" );
+		std::memcpy( &mStorage, &payload, sizeof( T ) );
+	}
+
+	EventType getTypeId() const { return mType; }
+	//! Size of the payload, zero for an empty event.
+	size_t size() const { return mSize; }
+	bool empty() const { return mSize == 0; }
+
+	const void* data() const { return &mStorage; }
+	template<typename T>
+	const T& get() const
+	{
+		assert( sizeof( T ) == mSize );
+		return *reinterpret_cast<const T*>( &mStorage );
+	}
+
+	void clear() { mSize = 0; }
+
+private:
+	using Storage = typename std::aligned_storage<kMaxSize, alignof( uint64_t )>::type;
+
+	EventType	mType;
+	uint32_t	mSize;
+	Storage		mStorage;
+};
+
+#pragma warning( push )
+#pragma warning( disable : 4068 )
+#pragma GCC visibility pop
+#pragma warning( pop )
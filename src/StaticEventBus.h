@@ -0,0 +1,197 @@
+//
+//  StaticEventBus.h
+//  Cinder-EventManager
+//
+//  Event bus over a set of event types fixed at compile time.
+//
+
+#pragma once
+#pragma warning( push )
+#pragma warning( disable : 4068 )
+/* The classes below are exported */
+#pragma GCC visibility push(default)
+#pragma warning( pop )
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "EventManagerBase.h"
+
+//! Queue for a subsystem whose events are all known at compile time. Events
+//! are plain values kept in one vector per type, and listeners are any
+//! objects callable with the events they care about, passed to update() or
+//! triggerEvent() instead of being registered. Which listener gets which
+//! event is settled by overload resolution, so there is no type id, map,
+//! virtual call or delegate in between and listener bodies can be inlined
+//! into the dispatch loop. A listener without an overload for an event
+//! simply doesn't see it.
+//!
+//!		StaticEventBus<MoveEvent, HitEvent> bus;
+//!		bus.queueEvent( MoveEvent{ id, position } );
+//!		bus.update( physics, audio, []( const HitEvent &hit ) { ... } );
+//!
+//! Events of EventData subclasses can be bridged to an EventManagerBase in
+//! both directions, see listenTo() and EventManagerForwarder.
+template<typename... Events>
+class StaticEventBus {
+	static_assert( sizeof...( Events ) > 0, "StaticEventBus needs at least one event type" );
+	static_assert( sizeof...( Events ) <= 256, "StaticEventBus supports at most 256 event types" );
+
+public:
+	StaticEventBus() = default;
+	StaticEventBus( const StaticEventBus& ) = delete;
+	StaticEventBus& operator=( const StaticEventBus& ) = delete;
+
+	//! Index of \a Event in the bus's event list.
+	template<typename Event>
+	static constexpr size_t indexOf()
+	{
+		const bool matches[] = { std::is_same<Event, Events>::value... };
+		for( size_t i = 0; i < sizeof...( Events ); ++i ) {
+			if( matches[i] )
+				return i;
+		}
+		return sizeof...( Events );
+	}
+
+	//! Calls every listener that accepts \a event, in argument order.
+	template<typename Event, typename... Listeners>
+	void triggerEvent( const Event &event, Listeners&&... listeners ) const
+	{
+		static_assert( indexOf<Event>() < sizeof...( Events ), "event type is not part of this StaticEventBus" );
+		deliver( event, listeners... );
+	}
+
+	//! Appends \a event for the next update(). May be called from listeners.
+	template<typename Event>
+	void queueEvent( Event event )
+	{
+		static_assert( indexOf<Event>() < sizeof...( Events ), "event type is not part of this StaticEventBus" );
+		std::get<indexOf<Event>()>( mQueues ).push_back( std::move( event ) );
+		mOrder.push_back( static_cast<uint8_t>( indexOf<Event>() ) );
+	}
+
+	bool empty() const { return mOrder.empty(); }
+	size_t size() const { return mOrder.size(); }
+
+	//! Delivers the queued events to \a listeners in the order they were
+	//! queued. Events queued meanwhile wait for the next update(). Must not
+	//! be called from a listener.
+	template<typename... Listeners>
+	void update( Listeners&&... listeners )
+	{
+		// Vectors are swapped rather than moved so both sets keep their
+		// capacity from one update to the next.
+		swapQueues( std::index_sequence_for<Events...>() );
+		mOrder.swap( mProcessingOrder );
+
+		size_t positions[sizeof...( Events )] = {};
+		for( auto index : mProcessingOrder )
+			dispatchAt<0>( index, positions, listeners... );
+
+		clearProcessing( std::index_sequence_for<Events...>() );
+		mProcessingOrder.clear();
+	}
+
+	//! Queues a copy of every \a Event the dynamic \a manager dispatches, so
+	//! events sent the usual way reach this bus's listeners. Event must be an
+	//! EventData subclass with a static TYPE. Call stopListeningTo() before
+	//! the bus is destroyed.
+	template<typename Event>
+	ListenerHandle listenTo( EventManagerBase &manager, int32_t priority = 0 )
+	{
+		static_assert( std::is_base_of<EventData, Event>::value, "only EventData subclasses can be bridged" );
+		return manager.addListener( fastdelegate::MakeDelegate( this, &StaticEventBus::receive<Event> ), Event::TYPE, priority );
+	}
+	template<typename Event>
+	bool stopListeningTo( EventManagerBase &manager )
+	{
+		return manager.removeListener( fastdelegate::MakeDelegate( this, &StaticEventBus::receive<Event> ), Event::TYPE );
+	}
+
+private:
+	//! Whether Listener has an overload for Event.
+	template<typename Listener, typename Event, typename = void>
+	struct Accepts : std::false_type {};
+	template<typename Listener, typename Event>
+	struct Accepts<Listener, Event, decltype( void( std::declval<Listener&>()( std::declval<const Event&>() ) ) )> : std::true_type {};
+
+	template<typename Event>
+	static void deliver( const Event & ) {}
+	template<typename Event, typename Listener, typename... Listeners>
+	static void deliver( const Event &event, Listener &listener, Listeners&... listeners )
+	{
+		call( event, listener, Accepts<Listener, Event>() );
+		deliver( event, listeners... );
+	}
+	template<typename Event, typename Listener>
+	static void call( const Event &event, Listener &listener, std::true_type ) { listener( event ); }
+	template<typename Event, typename Listener>
+	static void call( const Event &, Listener &, std::false_type ) {}
+
+	//! Delivers the next processed event of type \a index. Compiles down to
+	//! a chain of comparisons the compiler can turn into a jump table.
+	template<size_t I, typename... Listeners>
+	typename std::enable_if<( I < sizeof...( Events ) )>::type dispatchAt( uint8_t index, size_t *positions, Listeners&... listeners )
+	{
+		if( index == I )
+			deliver( std::get<I>( mProcessing )[positions[I]++], listeners... );
+		else
+			dispatchAt<I + 1>( index, positions, listeners... );
+	}
+	template<size_t I, typename... Listeners>
+	typename std::enable_if<( I == sizeof...( Events ) )>::type dispatchAt( uint8_t, size_t *, Listeners&... ) {}
+
+	template<size_t... Is>
+	void swapQueues( std::index_sequence<Is...> )
+	{
+		(void)std::initializer_list<int>{ ( std::get<Is>( mQueues ).swap( std::get<Is>( mProcessing ) ), 0 )... };
+	}
+	template<size_t... Is>
+	void clearProcessing( std::index_sequence<Is...> )
+	{
+		(void)std::initializer_list<int>{ ( std::get<Is>( mProcessing ).clear(), 0 )... };
+	}
+
+	template<typename Event>
+	void receive( EventDataRef event )
+	{
+		// Registered for Event::TYPE only.
+		queueEvent( static_cast<const Event&>( *event ) );
+	}
+
+	std::tuple<std::vector<Events>...>	mQueues;
+	//! Index into Events of each queued event, in queue order.
+	std::vector<uint8_t>				mOrder;
+	//! The queues being dispatched by update().
+	std::tuple<std::vector<Events>...>	mProcessing;
+	std::vector<uint8_t>				mProcessingOrder;
+};
+
+//! Listener for StaticEventBus that queues a copy of every EventData event
+//! it is given into a dynamic manager, so systems on the static bus can
+//! still feed listeners registered the usual way.
+//!
+//!		bus.update( physics, EventManagerForwarder( EventManager::get() ) );
+class EventManagerForwarder {
+public:
+	explicit EventManagerForwarder( EventManagerBase *manager ) : mManager( manager ) {}
+
+	template<typename Event>
+	typename std::enable_if<std::is_base_of<EventData, Event>::value>::type operator()( const Event &event ) const
+	{
+		mManager->queueEvent( makeEvent<Event>( event ) );
+	}
+
+private:
+	EventManagerBase	*mManager;
+};
+
+#pragma warning( push )
+#pragma warning( disable : 4068 )
+#pragma GCC visibility pop
+#pragma warning( pop )
@@ -0,0 +1,108 @@
+//
+//  ListenerTableTest.cpp
+//  Cinder-EventManager
+//
+//  Regression tests for listener bookkeeping: removing a listener or batch
+//  listener leaves a tombstone whose slot is reused by the next registration,
+//  and inserting in front of that tombstone must not hand the slot back to it.
+//
+
+#include "EventManager.h"
+
+#include <cstdio>
+#include <string>
+
+namespace {
+
+	struct TestEvent : public EventData {
+		static const EventType TYPE = 0x51e7a0c3;
+		TestEvent() : EventData( TYPE ) {}
+		const char* getName() const override { return "TestEvent"; }
+	};
+
+	std::string sCalls;
+
+	struct Listener {
+		explicit Listener( char name ) : mName( name ) {}
+		void onEvent( const EventData& ) { sCalls += mName; }
+		void onBatch( const EventSpan& ) { sCalls += mName; }
+		BorrowedEventListenerDelegate delegate() { return BorrowedEventListenerDelegate( this, &Listener::onEvent ); }
+		EventBatchListenerDelegate batchDelegate() { return EventBatchListenerDelegate( this, &Listener::onBatch ); }
+		char mName;
+	};
+
+	int sNumFailures = 0;
+
+	void check( bool condition, const char *what )
+	{
+		if( ! condition ) {
+			std::printf( "FAILED: %s\n", what );
+			++sNumFailures;
+		}
+	}
+
+	std::string fire( EventManager &manager )
+	{
+		sCalls.clear();
+		manager.triggerEvent( makeEvent<TestEvent>() );
+		return sCalls;
+	}
+
+	void testRemoveThenInsertInFront()
+	{
+		auto manager = EventManager::create( "ListenerTableTest", false );
+		Listener x( 'x' ), y( 'y' ), z( 'z' ), w( 'w' ), v( 'v' );
+		manager->addListener( x.delegate(), TestEvent::TYPE );
+		auto hy = manager->addListener( y.delegate(), TestEvent::TYPE );
+		manager->addListener( z.delegate(), TestEvent::TYPE );
+
+		// Leaves a tombstone, one of three entries isn't enough to compact.
+		check( manager->removeListener( hy ), "remove y" );
+		// Reuses y's slot and goes in front of the tombstone.
+		// No dispatch in between, which would compact the tombstone away.
+		auto hw = manager->addListener( w.delegate(), TestEvent::TYPE, 5 );
+		check( manager->removeListener( hw ), "remove w by handle" );
+		check( fire( *manager ) == "xz", "w is gone after removal" );
+		check( static_cast<bool>( manager->addListener( w.delegate(), TestEvent::TYPE ) ), "w can be added again" );
+		check( manager->removeListener( w.delegate(), TestEvent::TYPE ), "remove w by delegate" );
+
+		// Same again, with another listener taking the freed slot afterwards.
+		hy = manager->addListener( y.delegate(), TestEvent::TYPE );
+		check( manager->removeListener( hy ), "remove y again" );
+		hw = manager->addListener( w.delegate(), TestEvent::TYPE, 5 );
+		check( manager->removeListener( hw ), "remove w by handle again" );
+		auto hv = manager->addListener( v.delegate(), TestEvent::TYPE );
+		check( ! manager->removeListener( w.delegate(), TestEvent::TYPE ), "w is no longer registered" );
+		check( fire( *manager ) == "xzv", "v survives removing w" );
+		check( manager->removeListener( hv ), "remove v by handle" );
+		check( fire( *manager ) == "xz", "v is gone after removal" );
+	}
+
+	void testRemoveThenInsertBatchInFront()
+	{
+		auto manager = EventManager::create( "ListenerTableTest", false );
+		Listener x( 'x' ), y( 'y' ), z( 'z' ), w( 'w' );
+		manager->addBatchListener( x.batchDelegate(), TestEvent::TYPE );
+		auto hy = manager->addBatchListener( y.batchDelegate(), TestEvent::TYPE );
+		manager->addBatchListener( z.batchDelegate(), TestEvent::TYPE );
+
+		// Batch tombstones stay until the next dispatch, however many there are.
+		check( manager->removeListener( hy ), "remove batch y" );
+		auto hw = manager->addBatchListener( w.batchDelegate(), TestEvent::TYPE, 5 );
+		check( manager->removeListener( hw ), "remove batch w by handle" );
+		check( fire( *manager ) == "xz", "batch w is gone after removal" );
+		check( static_cast<bool>( manager->addBatchListener( w.batchDelegate(), TestEvent::TYPE ) ), "batch w can be added again" );
+		check( manager->removeBatchListener( w.batchDelegate(), TestEvent::TYPE ), "remove batch w by delegate" );
+	}
+
+}
+
+int main()
+{
+	testRemoveThenInsertInFront();
+	testRemoveThenInsertBatchInFront();
+
+	if( sNumFailures == 0 )
+		std::printf( "all tests passed\n" );
+	return sNumFailures == 0 ? 0 : 1;
+}